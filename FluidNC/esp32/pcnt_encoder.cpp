@@ -0,0 +1,83 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Driver/pcnt_encoder.h"
+
+#include "driver/pcnt.h"
+
+#include <atomic>
+
+// The hardware counter is 16 bits, so it is cleared at +-limit and the
+// overflow ISR accumulates the wraps into a 32-bit count.
+static const int16_t        limit = 30000;
+static pcnt_unit_t          unit  = PCNT_UNIT_0;
+static std::atomic<int32_t> overflow(0);
+
+static void IRAM_ATTR pcnt_overflow_isr(void* arg) {
+    uint32_t status;
+    pcnt_get_event_status(unit, &status);
+    if (status & PCNT_EVT_H_LIM) {
+        overflow += limit;
+    } else if (status & PCNT_EVT_L_LIM) {
+        overflow -= limit;
+    }
+}
+
+static bool config_channel(pcnt_channel_t channel, pinnum_t pulse_pin, pinnum_t ctrl_pin, bool reverse) {
+    // Each channel counts both edges of one signal, with the other signal
+    // deciding the direction.  Together the two channels count x4.
+    pcnt_config_t config = {
+        .pulse_gpio_num = pulse_pin,
+        .ctrl_gpio_num  = ctrl_pin,
+        .lctrl_mode     = reverse ? PCNT_MODE_KEEP : PCNT_MODE_REVERSE,
+        .hctrl_mode     = reverse ? PCNT_MODE_REVERSE : PCNT_MODE_KEEP,
+        .pos_mode       = PCNT_COUNT_DEC,
+        .neg_mode       = PCNT_COUNT_INC,
+        .counter_h_lim  = limit,
+        .counter_l_lim  = -limit,
+        .unit           = unit,
+        .channel        = channel,
+    };
+    return pcnt_unit_config(&config) == ESP_OK;
+}
+
+bool pcnt_encoder_init(int pcnt_unit, pinnum_t a_pin, pinnum_t b_pin) {
+    if (pcnt_unit < 0 || pcnt_unit >= PCNT_UNIT_MAX) {
+        return false;
+    }
+    unit = pcnt_unit_t(pcnt_unit);
+
+    if (!config_channel(PCNT_CHANNEL_0, a_pin, b_pin, false) || !config_channel(PCNT_CHANNEL_1, b_pin, a_pin, true)) {
+        return false;
+    }
+
+    // Ignore pulses shorter than about 1 us (80 APB clocks), which is far
+    // shorter than an edge spacing at any practical spindle speed.
+    pcnt_set_filter_value(unit, 80);
+    pcnt_filter_enable(unit);
+
+    pcnt_event_enable(unit, PCNT_EVT_H_LIM);
+    pcnt_event_enable(unit, PCNT_EVT_L_LIM);
+
+    pcnt_counter_pause(unit);
+    pcnt_counter_clear(unit);
+    overflow = 0;
+
+    pcnt_isr_service_install(0);
+    if (pcnt_isr_handler_add(unit, pcnt_overflow_isr, nullptr) != ESP_OK) {
+        return false;
+    }
+    pcnt_counter_resume(unit);
+    return true;
+}
+
+int32_t IRAM_ATTR pcnt_encoder_read() {
+    // If the counter wraps between reading the overflow and the counter,
+    // the overflow changes, so read again.
+    int32_t before;
+    int16_t count;
+    do {
+        before = overflow;
+        pcnt_get_counter_value(unit, &count);
+    } while (before != overflow);
+    return before + count;
+}
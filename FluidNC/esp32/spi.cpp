@@ -2,6 +2,7 @@
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
 
 #include "Driver/spi.h"
+#include "Driver/tmc_spi.h"  // tmc_spi_detach()
 
 #include "driver/spi_common.h"
 #include "src/Config.h"
@@ -33,6 +34,7 @@ bool spi_init_bus(pinnum_t sck_pin, pinnum_t miso_pin, pinnum_t mosi_pin, bool d
 
 // cppcheck-suppress unusedFunction
 void spi_deinit_bus() {
+    tmc_spi_detach();  // A bus with devices cannot be freed
     esp_err_t err = spi_bus_free(HSPI_HOST);
     log_debug("deinit spi " << int(err));
 }
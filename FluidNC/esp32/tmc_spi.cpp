@@ -1,9 +1,9 @@
 // Copyright (c) 2022 Mitch Bradley
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
 
-// There is no .h file to define the interface to this code.
-// It works by replacing weak methods in the TMCStepper library,
-// namely TMCStepper::read() and TMCStepper::write()
+// This works by replacing weak methods in the TMCStepper library,
+// namely TMCStepper::read() and TMCStepper::write().  Driver/tmc_spi.h
+// declares the batching interface that goes with them.
 
 // It uses low-level direct access to the SPI hardware instead of
 // trying to use the ESP-IDF spi_master() driver.  The reason for this
@@ -21,11 +21,14 @@
 // interface, which is basically direct access to the hardware registers
 // wrapped up to look like function calls (implemented as inlines, so
 // the compiler generates very compact code).  There are two downsides
-// to this method, neither of which really matter in our situation.
-// The first is that there is no locking to prevent this code from
-// interfering with SD card access that is already in progress.  That
-// is not a problem because TMC device access and SD Card access never
-// happen simultaneously.  The second is that the code polls for completion
+// to this method.  The first is that the spi_master driver does not know
+// about these transfers, and the status sampler reads the drivers while
+// a job may be streaming from the SD card.  So the bus is shared through
+// a spi_master device with no chip select, which exists only so that TMC
+// access can hold the bus lock (spi_device_acquire_bus()) and wait for any
+// SD card transaction in progress to finish.  The driver reprograms the
+// hardware for its own devices at the start of each transaction, after we
+// have reprogrammed it for ours.  The second is that the code polls for completion
 // without letting other tasks run.  That is not a problem because TMC
 // register access was effectively a blocking operation anyway, so it
 // doesn't matter whether it blocks at a low or high level of abstraction.
@@ -35,15 +38,293 @@
 // This code assumes that the SPI bus has already been initialized,
 // with SCK, MOSI, and MISO pins assigned, via SPIBus.cpp
 
+// On a daisy chain, every access shifts the whole chain, so writing one
+// register on each of six drivers costs six chain-length transfers.
+// Between tmc_spi_begin_batch() and tmc_spi_end_batch(), writes are
+// queued instead, and each register is then written on every driver in
+// the chain with one transfer.  Configuration registers are also
+// shadowed: the last value written or read stands in for a read, and
+// rewriting the same value is skipped.  The chips only lose those
+// registers if they lose power, so a full configuration forgets them first.
+// The ESP32 SPI buffer is 64 bytes, so a chain can have up to 12 drivers.
+
 #include "src/Config.h"
 #include "esp32/tmc_spi_support.h"
+#include "Driver/tmc_spi.h"
 #include <TMCStepper.h>  // https://github.com/teemuatlut/TMCStepper
 
+#include "driver/spi_master.h"
+#include <sdkconfig.h>
+
+#include <mutex>
+#include <vector>
+
+#ifdef CONFIG_IDF_TARGET_ESP32S3
+#    define HSPI_HOST SPI2_HOST
+#endif
+
+namespace {
+    const size_t packetLen = 5;
+
+    // Configuration registers that only change when we write them.  Status
+    // registers like DRV_STATUS, TSTEP and IOIN are always read from the chip.
+    const uint8_t shadowed[] = {
+        0x00,  // GCONF
+        0x09,  // SHORT_CONF
+        0x0A,  // DRV_CONF
+        0x0B,  // GLOBALSCALER
+        0x10,  // IHOLD_IRUN
+        0x11,  // TPOWERDOWN
+        0x13,  // TPWMTHRS
+        0x14,  // TCOOLTHRS
+        0x15,  // THIGH
+        0x6C,  // CHOPCONF
+        0x6D,  // COOLCONF
+        0x6E,  // DCCTRL
+        0x70,  // PWMCONF
+    };
+    const size_t n_shadowed = sizeof(shadowed);
+
+    // What we know about each driver: where it sits on the bus, and its shadowed registers
+    struct Shadow {
+        const TMC2130Stepper* driver;
+        uint16_t              cs;
+        int8_t                link;   // Position in the chain, 1 is nearest MOSI, or <= 0 if not chained
+        int8_t                chain;  // Number of drivers in the chain
+        uint32_t              valid;
+        uint32_t              value[n_shadowed];
+    };
+    std::vector<Shadow> shadows;
+
+    // A write waiting for the end of a batch
+    struct Pending {
+        TMC2130Stepper* driver;
+        uint16_t        cs;
+        int8_t          link;
+        int8_t          chain;
+        uint8_t         reg;
+        uint32_t        data;
+    };
+    std::vector<Pending> pending;
+    int                  batch_depth = 0;
+
+    // The motion task and the status sampler both use the bus
+    std::recursive_mutex bus_mutex;
+
+    // Our handle on the spi_master bus lock, shared with the SD card.
+    // Added on first use, because the bus is initialized after startup.
+    spi_device_handle_t bus_device = nullptr;
+    bool                bus_tried  = false;
+    int                 bus_depth  = 0;
+
+    // Hold this around anything that touches the SPI hardware.  The bus
+    // lock is taken by the outermost holder only; spi_master locks do not nest.
+    struct BusLock {
+        std::lock_guard<std::recursive_mutex> lock;
+
+        BusLock() : lock(bus_mutex) {
+            if (bus_depth++) {
+                return;
+            }
+            if (!bus_tried) {
+                bus_tried                            = true;
+                spi_device_interface_config_t devcfg = {};
+                devcfg.mode                          = 3;
+                devcfg.clock_speed_hz                = 2000000;
+                devcfg.spics_io_num                  = -1;
+                devcfg.queue_size                    = 1;
+                if (spi_bus_add_device(HSPI_HOST, &devcfg, &bus_device) != ESP_OK) {
+                    bus_device = nullptr;
+                    log_error("TMC SPI cannot share the SPI bus");
+                }
+            }
+            if (bus_device) {
+                spi_device_acquire_bus(bus_device, portMAX_DELAY);
+            }
+        }
+        ~BusLock() {
+            if (--bus_depth == 0 && bus_device) {
+                spi_device_release_bus(bus_device);
+            }
+        }
+    };
+
+    int shadowIndex(uint8_t reg) {
+        for (size_t i = 0; i < n_shadowed; i++) {
+            if (shadowed[i] == reg) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    Shadow& shadowFor(const TMC2130Stepper* driver) {
+        for (auto& shadow : shadows) {
+            if (shadow.driver == driver) {
+                return shadow;
+            }
+        }
+        shadows.push_back({ driver, 0, 0, 0, 0, {} });
+        return shadows.back();
+    }
+
+    void put_packet(uint8_t* out, uint8_t cmd, uint32_t data) {
+        out[0] = cmd;
+        out[1] = data >> 24;
+        out[2] = data >> 16;
+        out[3] = data >> 8;
+        out[4] = data >> 0;
+    }
+
+    uint32_t get_data(const uint8_t* in) {
+        return (uint32_t)in[1] << 24 | (uint32_t)in[2] << 16 | (uint32_t)in[3] << 8 | in[4];
+    }
+
+    // Send the queued writes.  Writes of the same register on drivers that
+    // share a chip select go out together, with the packet for the driver at
+    // link k placed (chain - k) packets from the start so that it has shifted
+    // into that driver when the transfer ends.  Drivers with nothing to write
+    // get a zero packet, which is a harmless read of GCONF.
+    void flush() {
+        if (pending.empty()) {
+            return;
+        }
+        tmc_spi_bus_setup();
+        while (!pending.empty()) {
+            auto   first = pending.front();
+            size_t n     = first.link > 0 ? first.chain : 1;
+            size_t bytes = n * packetLen;
+
+            uint8_t out[bytes] = { 0 };
+            for (auto it = pending.begin(); it != pending.end();) {
+                if (it->cs == first.cs && it->reg == first.reg) {
+                    size_t pos = it->link > 0 ? n - it->link : 0;
+                    put_packet(&out[pos * packetLen], it->reg | 0x80, it->data);
+                    it = pending.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            first.driver->switchCSpin(0);
+            tmc_spi_transfer_data(out, bytes * 8, NULL, 0);
+            first.driver->switchCSpin(1);
+        }
+    }
+
+    // Record where a driver sits on the bus, for use outside its member functions
+    Shadow& locate(const TMC2130Stepper* driver, uint16_t cs, int8_t link, int8_t chain) {
+        Shadow& shadow = shadowFor(driver);
+        shadow.cs      = cs;
+        shadow.link    = link;
+        shadow.chain   = chain;
+        return shadow;
+    }
+
+    bool hasPending(const TMC2130Stepper* driver) {
+        for (auto& p : pending) {
+            if (p.driver == driver) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+void tmc_spi_begin_batch() {
+    std::lock_guard<std::recursive_mutex> lock(bus_mutex);
+    ++batch_depth;
+}
+
+void tmc_spi_forget_registers() {
+    std::lock_guard<std::recursive_mutex> lock(bus_mutex);
+    for (auto& shadow : shadows) {
+        shadow.valid = 0;
+    }
+}
+
+void tmc_spi_end_batch() {
+    BusLock lock;
+    if (batch_depth > 0 && --batch_depth == 0) {
+        flush();
+    }
+}
+
+// Each chip select needs one command transfer and one response transfer,
+// no matter how many of its drivers are in the list.
+void tmc_spi_read_chain(TMC2130Stepper* const* drivers, size_t count, uint8_t reg, uint32_t* values) {
+    BusLock lock;
+
+    flush();
+    tmc_spi_bus_setup();
+
+    bool done[count] = { false };
+    for (size_t i = 0; i < count; i++) {
+        if (done[i]) {
+            continue;
+        }
+        Shadow  first = shadowFor(drivers[i]);  // A copy, the vector can grow below
+        size_t  n     = first.link > 0 ? first.chain : 1;
+        size_t  bytes = n * packetLen;
+
+        uint8_t out[bytes] = { 0 };
+        for (size_t j = i; j < count; j++) {
+            Shadow& shadow = shadowFor(drivers[j]);
+            if (shadow.cs == first.cs) {
+                size_t pos = shadow.link > 0 ? n - shadow.link : 0;
+                put_packet(&out[pos * packetLen], reg, 0);
+            }
+        }
+        drivers[i]->switchCSpin(0);
+        tmc_spi_transfer_data(out, bytes * 8, NULL, 0);
+        drivers[i]->switchCSpin(1);
+
+        // The data from the driver at link k arrives (chain - k) packets in
+        uint8_t in[bytes] = { 0 };
+        drivers[i]->switchCSpin(0);
+        tmc_spi_transfer_data(in, bytes * 8, in, bytes * 8);
+        drivers[i]->switchCSpin(1);
+
+        for (size_t j = i; j < count; j++) {
+            Shadow& shadow = shadowFor(drivers[j]);
+            if (shadow.cs == first.cs) {
+                size_t pos = shadow.link > 0 ? n - shadow.link : 0;
+                values[j]  = get_data(&in[pos * packetLen]);
+                done[j]    = true;
+            }
+        }
+    }
+}
+
 // Replace the library's weak definition of TMC2130Stepper::write()
 // This is executed in the object context so it has access to class
 // data such as the CS pin that switchCSpin() uses
 void TMC2130Stepper::write(uint8_t reg, uint32_t data) {
+    BusLock lock;
+
+    Shadow& shadow = locate(this, _pinCS, link_index, int8_t(chain_length));
+    int     index  = shadowIndex(reg);
+    if (index >= 0) {
+        if ((shadow.valid & (1 << index)) && shadow.value[index] == data) {
+            return;  // The chip already has this value
+        }
+        shadow.value[index] = data;
+        shadow.valid |= 1 << index;
+    }
+
     log_verbose("TMC reg " << to_hex(reg) << " write " << to_hex(data));
+
+    if (batch_depth) {
+        for (auto& p : pending) {
+            if (p.driver == this && p.reg == reg) {
+                p.data = data;  // Only the last value matters
+                return;
+            }
+        }
+        pending.push_back({ this, _pinCS, link_index, int8_t(chain_length), reg, data });
+        return;
+    }
+
     tmc_spi_bus_setup();
 
     switchCSpin(0);
@@ -53,6 +334,21 @@ void TMC2130Stepper::write(uint8_t reg, uint32_t data) {
 
 // Replace the library's weak definition of TMC2130Stepper::read()
 uint32_t TMC2130Stepper::read(uint8_t reg) {
+    BusLock lock;
+
+    Shadow& shadow = locate(this, _pinCS, link_index, int8_t(chain_length));
+    int     index  = shadowIndex(reg);
+    if (index >= 0) {
+        if (shadow.valid & (1 << index)) {
+            return shadow.value[index];
+        }
+    }
+
+    // The read must see this driver's queued writes
+    if (hasPending(this)) {
+        flush();
+    }
+
     tmc_spi_bus_setup();
 
     switchCSpin(0);
@@ -65,11 +361,10 @@ uint32_t TMC2130Stepper::read(uint8_t reg) {
     // to account for the chips in the chain after the target one.  The
     // data for those "after" chips will appear at the beginning of the input
     // buffer, with the desired data for the target chip at the end.
-    const size_t packetLen      = 5;
-    size_t       afterChips     = link_index > 0 ? chain_length - link_index : 0;
-    size_t       dummy_in_bytes = afterChips * packetLen;
-    size_t       total_bytes    = (afterChips + 1) * packetLen;
-    size_t       total_bits     = total_bytes * 8;
+    size_t afterChips     = link_index > 0 ? chain_length - link_index : 0;
+    size_t dummy_in_bytes = afterChips * packetLen;
+    size_t total_bytes    = (afterChips + 1) * packetLen;
+    size_t total_bits     = total_bytes * 8;
 
     uint8_t in[total_bytes] = { 0 };
 
@@ -90,5 +385,18 @@ uint32_t TMC2130Stepper::read(uint8_t reg) {
 
     log_verbose("TMC reg " << to_hex(reg) << " read " << to_hex(data) << " status " << to_hex(status));
 
+    if (index >= 0) {
+        shadow.value[index] = data;
+        shadow.valid |= 1 << index;
+    }
     return data;
 }
+
+void tmc_spi_detach() {
+    std::lock_guard<std::recursive_mutex> lock(bus_mutex);
+    if (bus_device) {
+        spi_bus_remove_device(bus_device);
+        bus_device = nullptr;
+    }
+    bus_tried = false;
+}
@@ -0,0 +1,11 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "src/Pins/PinDetail.h"  // pinnum_t
+
+// Quadrature encoder interface, counting all four edges of each A/B cycle
+// on PCNT unit pcnt_unit.  Returns false if the unit does not exist.
+
+bool    pcnt_encoder_init(int pcnt_unit, pinnum_t a_pin, pinnum_t b_pin);
+int32_t pcnt_encoder_read();
@@ -0,0 +1,27 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class TMC2130Stepper;
+
+// Trinamic SPI register access.  Between these calls, register writes to
+// Trinamic SPI drivers are queued, then each register is written on every
+// driver in a daisy chain with a single transfer.  Batches can nest.
+
+void tmc_spi_begin_batch();
+void tmc_spi_end_batch();
+
+// Forget the shadowed register values, so the next full configuration
+// writes every register even if the drivers have lost power meanwhile.
+void tmc_spi_forget_registers();
+
+// Read one register from each of count drivers into values[], with one
+// command and one response transfer per daisy chain.
+void tmc_spi_read_chain(TMC2130Stepper* const* drivers, size_t count, uint8_t reg, uint32_t* values);
+
+// Let go of the SPI bus, which TMC access shares with the SD card, so
+// that the bus can be freed.  The next TMC access takes it again.
+void tmc_spi_detach();
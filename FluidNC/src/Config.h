@@ -23,12 +23,20 @@ Some features should not be changed. See notes below.
 // machine.h is #included below, after some definitions
 // that the machine file might choose to undefine.
 
-const int MAX_N_AXIS = 6;
+// The number of axes the firmware is built for, up to 9 (XYZABCUVW).
+// Per-axis arrays in the planner, the segment buffer and the coordinate
+// systems are sized by it, so only builds for machines with U, V or W
+// axes should raise it, with -DMAX_AXES=9 in the build flags.
+#ifndef MAX_AXES
+#    define MAX_AXES 6
+#endif
+const int MAX_N_AXIS = MAX_AXES;
+static_assert(MAX_N_AXIS >= 3 && MAX_N_AXIS <= 9, "MAX_AXES must be between 3 and 9");
 
 const int MAX_MESSAGE_LINE = 256;
 
 // Axis array index values. Must start with 0 and be continuous.
-// Note: You set the number of axes used by changing MAX_N_AXIS.
+// Note: You set the number of axes built in with MAX_AXES above.
 // Be sure to define pins or servos in the machine definition file.
 const int X_AXIS = 0;  // Axis indexing value.
 const int Y_AXIS = 1;
@@ -36,6 +44,9 @@ const int Z_AXIS = 2;
 const int A_AXIS = 3;
 const int B_AXIS = 4;
 const int C_AXIS = 5;
+const int U_AXIS = 6;  // U, V and W are linear axes parallel to X, Y and Z
+const int V_AXIS = 7;
+const int W_AXIS = 8;
 
 const int X2_AXIS = (X_AXIS + MAX_N_AXIS);
 const int Y2_AXIS = (Y_AXIS + MAX_N_AXIS);
@@ -43,6 +54,9 @@ const int Z2_AXIS = (Z_AXIS + MAX_N_AXIS);
 const int A2_AXIS = (A_AXIS + MAX_N_AXIS);
 const int B2_AXIS = (B_AXIS + MAX_N_AXIS);
 const int C2_AXIS = (C_AXIS + MAX_N_AXIS);
+const int U2_AXIS = (U_AXIS + MAX_N_AXIS);
+const int V2_AXIS = (V_AXIS + MAX_N_AXIS);
+const int W2_AXIS = (W_AXIS + MAX_N_AXIS);
 
 const int SUPPORT_TASK_CORE = 0;  // Reference: CONFIG_ARDUINO_RUNNING_CORE = 1
 
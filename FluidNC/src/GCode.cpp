@@ -19,6 +19,7 @@
 #include "Machine/MachineConfig.h"
 #include "Parameters.h"
 #include "Flowcontrol.h"
+#include "Raster.h"  // raster_take, raster_linear
 
 #include <string.h>  // memset
 #include <math.h>    // sqrt etc.
@@ -55,7 +56,8 @@ gc_modal_t modal_defaults = {
     ToolChange::Disable,
     SetToolNumber::Disable,
     IoControl::None,
-    Override::ParkingMotion
+    Override::ParkingMotion,
+    SpindleSpeedMode::Rpm
 };
 // clang-format on
 
@@ -78,6 +80,40 @@ void gc_sync_position() {
     motor_steps_to_mpos(gc_state.position, get_motor_steps());
 }
 
+// G96 surface speed in mm/min.  S is in meters/min, or feet/min in G20 mode.
+static float css_surface_speed(float s) {
+    return s * (gc_state.modal.units == Units::Inches ? 12 * MM_PER_INCH : 1000.0f);
+}
+
+// Machine X position of the spindle axis, which is X0 in work coordinates
+static float css_x_origin() {
+    return gc_state.coord_system[X_AXIS] + gc_state.coord_offset[X_AXIS];
+}
+
+static float css_max_speed() {
+    return gc_state.css_max_speed > 0 ? gc_state.css_max_speed : spindle->maxSpeed();
+}
+
+// The spindle speed that gives surface speed s at machine X position x, clamped
+// to the G96 limit.  At the center, where the speed would be infinite, the
+// clamp applies.
+static float css_rpm(float s, float x) {
+    float circumference = 2.0f * float(M_PI) * fabsf(x - css_x_origin());
+    float max_speed     = css_max_speed();
+    float surface_speed = css_surface_speed(s);
+    if (circumference * max_speed <= surface_speed) {
+        return max_speed;
+    }
+    return surface_speed / circumference;
+}
+
+float gc_spindle_rpm() {
+    if (gc_state.modal.spindle_speed_mode == SpindleSpeedMode::SurfaceSpeed) {
+        return css_rpm(gc_state.spindle_speed, gc_state.position[X_AXIS]);
+    }
+    return gc_state.spindle_speed;
+}
+
 static bool decode_format_string(const char* comment, size_t& index, size_t len, const char*& format) {
     // comment[index] is '%'
     const char* f   = comment + index;
@@ -258,6 +294,7 @@ Error gc_execute_line(char* line) {
     bool probeExplicit = false;
     bool probeAway     = false;
     bool probeNoError  = false;
+    int  probeTouches  = 0;  // G38.2/G38.3 L word: multi-touch probing
     bool syncLaser     = false;
     bool disableLaser  = false;
     bool laserIsMotion = false;
@@ -409,6 +446,25 @@ Error gc_execute_line(char* line) {
                         gc_block.modal.motion = Motion::CcwArc;
                         mg_word_bit           = ModalGroup::MG1;
                         break;
+                    case 33:  // G33 - spindle-synchronized motion, G33.1 - rigid tapping
+                        if (!config->_spindle_encoder->exists()) {
+                            log_info("No spindle encoder defined");
+                            FAIL(Error::GcodeUnsupportedCommand);  // [Unsupported G command]
+                        }
+                        axis_command = AxisCommand::MotionMode;
+                        switch (mantissa) {
+                            case 0:
+                                gc_block.modal.motion = Motion::SpindleSync;
+                                break;
+                            case 10:
+                                gc_block.modal.motion = Motion::RigidTap;
+                                break;
+                            default:
+                                FAIL(Error::GcodeUnsupportedCommand);  // [Unsupported G33.x command]
+                        }
+                        mantissa    = 0;  // Set to zero to indicate valid non-integer G command.
+                        mg_word_bit = ModalGroup::MG1;
+                        break;
                     case 38:  // G38 - probe
                         //only allow G38 "Probe" commands if a probe pin is defined.
                         if (!config->_probe->exists()) {
@@ -570,6 +626,14 @@ Error gc_execute_line(char* line) {
                         mg_word_bit                 = ModalGroup::MG12;
                         break;
                         // NOTE: G59.x are not supported.
+                    case 96:
+                        gc_block.modal.spindle_speed_mode = SpindleSpeedMode::SurfaceSpeed;
+                        mg_word_bit                       = ModalGroup::MG14;
+                        break;
+                    case 97:
+                        gc_block.modal.spindle_speed_mode = SpindleSpeedMode::Rpm;
+                        mg_word_bit                       = ModalGroup::MG14;
+                        break;
                     case 61:
                         if (mantissa != 0) {
                             FAIL(Error::GcodeUnsupportedCommand);  // [G61.1 not supported]
@@ -750,9 +814,9 @@ Error gc_execute_line(char* line) {
                         }
                         break;
 
-                    case 'D':  // Unsupported word used for parameter debugging
-                        axis_word_bit = GCodeWord::D;
-                        log_info("Value is " << value);
+                    case 'D':  // G96 speed limit, otherwise used for parameter debugging
+                        axis_word_bit     = GCodeWord::D;
+                        gc_block.values.d = value;
                         break;
                     case 'E':
                         axis_word_bit     = GCodeWord::E;
@@ -847,6 +911,33 @@ Error gc_execute_line(char* line) {
                             FAIL(Error::GcodeUnsupportedCommand);
                         }
                         break;
+                    case 'U':
+                        if (n_axis > U_AXIS) {
+                            axis_word_bit               = GCodeWord::U;
+                            gc_block.values.xyz[U_AXIS] = value;
+                            set_bitnum(axis_words, U_AXIS);
+                        } else {
+                            FAIL(Error::GcodeUnsupportedCommand);
+                        }
+                        break;
+                    case 'V':
+                        if (n_axis > V_AXIS) {
+                            axis_word_bit               = GCodeWord::V;
+                            gc_block.values.xyz[V_AXIS] = value;
+                            set_bitnum(axis_words, V_AXIS);
+                        } else {
+                            FAIL(Error::GcodeUnsupportedCommand);
+                        }
+                        break;
+                    case 'W':
+                        if (n_axis > W_AXIS) {
+                            axis_word_bit               = GCodeWord::W;
+                            gc_block.values.xyz[W_AXIS] = value;
+                            set_bitnum(axis_words, W_AXIS);
+                        } else {
+                            FAIL(Error::GcodeUnsupportedCommand);
+                        }
+                        break;
                     default:
                         FAIL(Error::GcodeUnsupportedCommand);
                 }
@@ -959,6 +1050,25 @@ Error gc_execute_line(char* line) {
         }
     }
     // clear_bitnum(value_words, GCodeWord::F); // NOTE: Single-meaning value word. Set at end of error-checking.
+    // [4a. Set spindle speed mode ]: G96 requires S, the surface speed. D is the optional RPM limit.
+    bool cssModeChange = bitnum_is_true(command_words, ModalGroup::MG14);
+    if (cssModeChange && gc_block.modal.spindle_speed_mode == SpindleSpeedMode::SurfaceSpeed) {
+        if (n_axis <= X_AXIS) {
+            FAIL(Error::GcodeUnsupportedCommand);
+        }
+        if (bitnum_is_false(value_words, GCodeWord::S)) {
+            FAIL(Error::GcodeValueWordMissing);
+        }
+        if (bitnum_is_true(value_words, GCodeWord::D)) {
+            if (gc_block.values.d < 0.0) {
+                FAIL(Error::NegativeValue);
+            }
+        } else {
+            gc_block.values.d = 0;
+        }
+    } else if (bitnum_is_true(value_words, GCodeWord::D)) {
+        log_info("Value is " << gc_block.values.d);
+    }
     // [4. Set spindle speed ]: S is negative (done.)
     if (bitnum_is_false(value_words, GCodeWord::S)) {
         gc_block.values.s = gc_state.spindle_speed;
@@ -1238,6 +1348,22 @@ Error gc_execute_line(char* line) {
             if (!axis_words) {
                 axis_command = AxisCommand::None;
             }
+        } else if (gc_block.modal.motion == Motion::SpindleSync || gc_block.modal.motion == Motion::RigidTap) {
+            // [G33/G33.1 Errors]: No axis words. K, the distance per spindle revolution, is missing or not
+            //   positive. Spindle is off or has no speed. The feed rate comes from the spindle so F is not needed.
+            if (!axis_words) {
+                FAIL(Error::GcodeNoAxisWords);  // [No axis words]
+            }
+            if (bitnum_is_false(value_words, GCodeWord::K) || gc_block.values.ijk[Z_AXIS] <= 0.0f) {
+                FAIL(Error::GcodeValueWordMissing);  // [K word missing]
+            }
+            if (gc_block.modal.spindle == SpindleState::Disable || gc_block.values.s <= 0.0f) {
+                FAIL(Error::GcodeUnsupportedCommand);  // [Spindle not running]
+            }
+            if (gc_block.modal.units == Units::Inches) {
+                gc_block.values.ijk[Z_AXIS] *= MM_PER_INCH;
+            }
+            clear_bitnum(value_words, GCodeWord::K);
             // All remaining motion modes (all but G0 and G80), require a valid feed rate value. In units per mm mode,
             // the value must be positive. In inverse time mode, a positive value must be passed with each block.
         } else {
@@ -1427,6 +1553,30 @@ Error gc_execute_line(char* line) {
                     }
                     clear_bitnum(value_words, GCodeWord::P);  // allow P to be used
 
+                    // L touches at feed Q, or at F if there is no Q, each
+                    // from R back along the probe direction
+                    if (!probeAway && bitnum_is_true(value_words, GCodeWord::L)) {
+                        if (bitnum_is_false(value_words, GCodeWord::R)) {
+                            FAIL(Error::GcodeValueWordMissing);
+                        }
+                        if (gc_block.values.l < 1 || gc_block.values.r <= 0 ||
+                            (bitnum_is_true(value_words, GCodeWord::Q) && gc_block.values.q <= 0)) {
+                            FAIL(Error::NegativeValue);
+                        }
+                        if (bitnum_is_false(value_words, GCodeWord::Q)) {
+                            gc_block.values.q = gc_block.values.f;
+                        } else if (!nonmodalG38 && gc_block.modal.units == Units::Inches) {
+                            gc_block.values.q *= MM_PER_INCH;
+                        }
+                        if (!nonmodalG38 && gc_block.modal.units == Units::Inches) {
+                            gc_block.values.r *= MM_PER_INCH;
+                        }
+                        probeTouches = gc_block.values.l;
+                        clear_bitnum(value_words, GCodeWord::L);
+                        clear_bitnum(value_words, GCodeWord::Q);
+                        clear_bitnum(value_words, GCodeWord::R);
+                    }
+
                     if (!axis_words) {
                         FAIL(Error::GcodeNoAxisWords);  // [No axis words]
                     }
@@ -1451,7 +1601,8 @@ Error gc_execute_line(char* line) {
     if (axis_command != AxisCommand::None) {
         clear_bits(value_words,
                    (bitnum_to_mask(GCodeWord::X) | bitnum_to_mask(GCodeWord::Y) | bitnum_to_mask(GCodeWord::Z) |
-                    bitnum_to_mask(GCodeWord::A) | bitnum_to_mask(GCodeWord::B) | bitnum_to_mask(GCodeWord::C)));  // Remove axis words.
+                    bitnum_to_mask(GCodeWord::A) | bitnum_to_mask(GCodeWord::B) | bitnum_to_mask(GCodeWord::C) |
+                    bitnum_to_mask(GCodeWord::U) | bitnum_to_mask(GCodeWord::V) | bitnum_to_mask(GCodeWord::W)));  // Remove axis words.
     }
     clear_bits(value_words, (bitnum_to_mask(GCodeWord::D) | bitnum_to_mask(GCodeWord::O)));
     if (value_words) {
@@ -1480,7 +1631,7 @@ Error gc_execute_line(char* line) {
             FAIL(Error::InvalidJogCommand);
         }
         // Initialize planner data to current spindle and coolant modal state.
-        pl_data->spindle_speed  = gc_state.spindle_speed;
+        pl_data->spindle_speed  = gc_spindle_rpm();
         pl_data->spindle        = gc_state.modal.spindle;
         pl_data->coolant        = gc_state.modal.coolant;
         bool  cancelledInflight = false;
@@ -1538,19 +1689,26 @@ Error gc_execute_line(char* line) {
     // [3. Set feed rate ]:
     gc_state.feed_rate = gc_block.values.f;   // Always copy this value. See feed rate error-checking.
     pl_data->feed_rate = gc_state.feed_rate;  // Record data for planner use.
+    // [4a. Set spindle speed mode ]:
+    if (cssModeChange) {
+        gc_state.modal.spindle_speed_mode = gc_block.modal.spindle_speed_mode;
+        if (gc_block.modal.spindle_speed_mode == SpindleSpeedMode::SurfaceSpeed) {
+            gc_state.css_max_speed = gc_block.values.d;
+        }
+    }
     // [4. Set spindle speed ]:
-    if ((gc_state.spindle_speed != gc_block.values.s) || syncLaser) {
+    if ((gc_state.spindle_speed != gc_block.values.s) || syncLaser || cssModeChange) {
+        gc_state.spindle_speed = gc_block.values.s;  // Update spindle speed state.
         if (gc_state.modal.spindle != SpindleState::Disable && !laserIsMotion && !state_is(State::CheckMode)) {
             protocol_buffer_synchronize();
-            spindle->setState(gc_state.modal.spindle, disableLaser ? 0 : (uint32_t)gc_block.values.s);
+            spindle->setState(gc_state.modal.spindle, disableLaser ? 0 : (uint32_t)gc_spindle_rpm());
             gc_ovr_changed();
         }
-        gc_state.spindle_speed = gc_block.values.s;  // Update spindle speed state.
     }
     // NOTE: Pass zero spindle speed for all restricted laser motions.
     if (!disableLaser) {
-        pl_data->spindle_speed = gc_state.spindle_speed;  // Record data for planner use.
-    }                                                     // else { pl_data->spindle_speed = 0.0; } // Initialized as zero already.
+        pl_data->spindle_speed = gc_spindle_rpm();  // Record data for planner use.
+    }                                               // else { pl_data->spindle_speed = 0.0; } // Initialized as zero already.
     // [5. Select tool ]: NOT SUPPORTED. Only tracks tool value.
     //	gc_state.tool = gc_block.values.t;
     // [M6. Change tool ]:
@@ -1746,14 +1904,31 @@ Error gc_execute_line(char* line) {
     // NOTE: Commands G10,G28,G30,G92 lock out and prevent axis words from use in motion modes.
     // Enter motion modes only if there are axis words or a motion mode command word in the block.
     gc_state.modal.motion = gc_block.modal.motion;
+    // In G96 mode, the stepper recomputes the spindle speed from the X position as the motion executes.
+    if (gc_state.modal.spindle_speed_mode == SpindleSpeedMode::SurfaceSpeed && pl_data->spindle_speed > 0) {
+        pl_data->css_surface_speed = css_surface_speed(gc_state.spindle_speed);
+        pl_data->css_max_speed     = css_max_speed();
+        pl_data->css_x_origin      = css_x_origin();
+    }
     if (gc_state.modal.motion != Motion::None) {
         if (axis_command == AxisCommand::MotionMode) {
             GCUpdatePos gc_update_pos = GCUpdatePos::Target;
             if (gc_state.modal.motion == Motion::Linear) {
-                mc_linear(gc_block.values.xyz, pl_data, gc_state.position);
+                pl_data->raster = raster_take();
+                if (pl_data->raster) {
+                    raster_linear(gc_block.values.xyz, pl_data, gc_state.position);
+                } else {
+                    mc_linear(gc_block.values.xyz, pl_data, gc_state.position);
+                }
             } else if (gc_state.modal.motion == Motion::Seek) {
                 pl_data->motion.rapidMotion = 1;  // Set rapid motion flag.
                 mc_linear(gc_block.values.xyz, pl_data, gc_state.position);
+            } else if ((gc_state.modal.motion == Motion::SpindleSync) || (gc_state.modal.motion == Motion::RigidTap)) {
+                gc_update_pos = mc_spindle_sync(gc_block.values.xyz,
+                                                pl_data,
+                                                gc_state.position,
+                                                gc_block.values.ijk[Z_AXIS],
+                                                gc_state.modal.motion == Motion::RigidTap);
             } else if ((gc_state.modal.motion == Motion::CwArc) || (gc_state.modal.motion == Motion::CcwArc)) {
                 mc_arc(gc_block.values.xyz,
                        pl_data,
@@ -1771,7 +1946,18 @@ Error gc_execute_line(char* line) {
                 if (!ALLOW_FEED_OVERRIDE_DURING_PROBE_CYCLES) {
                     pl_data->motion.noFeedOverride = 1;
                 }
-                gc_update_pos = mc_probe_cycle(gc_block.values.xyz, pl_data, probeAway, probeNoError, axis_words, gc_block.values.p);
+                if (probeTouches) {
+                    gc_update_pos = mc_probe_multi(gc_block.values.xyz,
+                                                   pl_data,
+                                                   probeNoError,
+                                                   axis_words,
+                                                   gc_block.values.p,
+                                                   probeTouches,
+                                                   gc_block.values.q,
+                                                   gc_block.values.r);
+                } else {
+                    gc_update_pos = mc_probe_cycle(gc_block.values.xyz, pl_data, probeAway, probeNoError, axis_words, gc_block.values.p);
+                }
             }
             // As far as the parser is concerned, the position is now == target. In reality the
             // motion control system might still be processing the action and the real tool position
@@ -43,6 +43,7 @@ enum class ModalGroup : uint8_t {
     MM8  = 13,  // [M7,M8,M9] Coolant control
     MM9  = 14,  // [M56] Override control
     MM10 = 15,  // [M62, M63, M64, M65, M67, M68] User Defined http://linuxcnc.org/docs/html/gcode/overview.html#_modal_groups
+    MG14 = 16,  // [G96,G97] Spindle speed mode
 };
 
 // Command actions for within execution-type modal groups (motion, stopping, non-modal). Used
@@ -73,6 +74,8 @@ enum class Motion : gcodenum_t {
     Linear             = 10,   // G1
     CwArc              = 20,   // G2
     CcwArc             = 30,   // G3
+    SpindleSync        = 330,  // G33
+    RigidTap           = 331,  // G33.1
     ProbeToward        = 382,  // G38.2
     ProbeTowardNoError = 383,  // G38.3
     ProbeAway          = 384,  // G38.4
@@ -126,6 +129,12 @@ enum class CutterCompensation : gcodenum_t {
     Enable  = 410,
 };
 
+// Modal Group G14: Spindle speed mode
+enum class SpindleSpeedMode : gcodenum_t {
+    Rpm          = 970,  // G97 Default
+    SurfaceSpeed = 960,  // G96
+};
+
 // Modal Group G13: Control mode
 enum class ControlMode : gcodenum_t {
     ExactPath = 610,  // G61
@@ -208,6 +217,9 @@ enum class GCodeWord : uint8_t {
     C = 17,
     O = 18,
     D = 19,  // For debugging
+    U = 20,
+    V = 21,
+    W = 22,
 
 };
 
@@ -263,9 +275,12 @@ struct gc_modal_t {
     SetToolNumber set_tool_number;
     IoControl     io_control;  // {M62, M63, M67}
     Override      override;    // {M56}
+
+    SpindleSpeedMode spindle_speed_mode;  // {G96,G97}
 };
 
 struct gc_values_t {
+    float    d;                // G96 maximum spindle speed
     uint8_t  e;                // M67
     float    f;                // Feed
     float    ijk[3];           // I,J,K Axis arc offsets - only 3 are possible
@@ -283,7 +298,8 @@ struct gc_values_t {
 struct parser_state_t {
     gc_modal_t modal;
 
-    float    spindle_speed;  // RPM
+    float    spindle_speed;  // RPM, or surface speed in G96 mode
+    float    css_max_speed;  // G96 spindle speed limit, RPM. 0 = spindle maximum
     float    feed_rate;      // Millimeters/min
     uint32_t tool;           // Tracks tool number
     uint32_t selected_tool;  // tool from T value
@@ -325,6 +341,9 @@ void  gc_exec_linef(bool sync_after, Channel& out, const char* format, ...);
 // Set g-code parser position. Input in steps.
 void gc_sync_position();
 
+// The spindle speed in RPM, which in G96 mode depends on the X position
+float gc_spindle_rpm();
+
 void gc_ngc_changed(CoordIndex coord);
 void gc_wco_changed();
 void gc_ovr_changed();
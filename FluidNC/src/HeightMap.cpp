@@ -0,0 +1,209 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "HeightMap.h"
+
+#include "Machine/MachineConfig.h"
+#include "MotionControl.h"  // mc_linear, mc_probe_cycle
+#include "Protocol.h"       // protocol_buffer_synchronize
+#include "GCode.h"          // gc_state, gc_sync_position
+#include "FileStream.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+    struct GridArgs {
+        float       x = NAN, y = NAN, dx = NAN, dy = NAN;
+        float       columns = NAN, rows = NAN;
+        float       z = NAN, h = NAN;
+        float       probe_feed = NAN, travel_feed = NAN;
+        std::string file = "heightmap.bin";
+    };
+
+    // Parse letter-number words, G-code style, and an optional file name
+    bool parse(const char* value, GridArgs& args) {
+        const char* s = value;
+        while (*s) {
+            if (isspace(*s)) {
+                ++s;
+                continue;
+            }
+            char  letter = toupper(*s);
+            char* end;
+            float number = strtof(s + 1, &end);
+            if (end == s + 1 || !strchr("XYIJCRZHFS", letter)) {
+                // Not a word, so it is the file name
+                const char* name_end = s;
+                while (*name_end && !isspace(*name_end)) {
+                    ++name_end;
+                }
+                args.file.assign(s, name_end);
+                s = name_end;
+                continue;
+            }
+            switch (letter) {
+                case 'X':
+                    args.x = number;
+                    break;
+                case 'Y':
+                    args.y = number;
+                    break;
+                case 'I':
+                    args.dx = number;
+                    break;
+                case 'J':
+                    args.dy = number;
+                    break;
+                case 'C':
+                    args.columns = number;
+                    break;
+                case 'R':
+                    args.rows = number;
+                    break;
+                case 'Z':
+                    args.z = number;
+                    break;
+                case 'H':
+                    args.h = number;
+                    break;
+                case 'F':
+                    args.probe_feed = number;
+                    break;
+                case 'S':
+                    args.travel_feed = number;
+                    break;
+            }
+            s = end;
+        }
+        for (float v : { args.x, args.y, args.dx, args.dy, args.columns, args.rows, args.z, args.h, args.probe_feed, args.travel_feed }) {
+            if (std::isnan(v)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Queue a move in work coordinates without waiting for it
+    bool travel(float x, float y, float z, float feed) {
+        float* wco = get_wco();
+        float  target[MAX_N_AXIS];
+        copyAxes(target, gc_state.position);
+        target[X_AXIS] = x + wco[X_AXIS];
+        target[Y_AXIS] = y + wco[Y_AXIS];
+        target[Z_AXIS] = z + wco[Z_AXIS];
+
+        plan_line_data_t plan_data      = {};
+        plan_data.motion.noFeedOverride = 1;
+        plan_data.spindle               = SpindleState::Disable;
+        plan_data.feed_rate             = feed;
+        plan_data.line_number           = gc_state.line_number;
+
+        mc_linear(target, &plan_data, gc_state.position);
+        copyAxes(gc_state.position, target);
+        return !sys.abort;
+    }
+
+    // Probe down from the current position and return the contact height
+    // in work coordinates.
+    bool probe(float z, float feed, float& height) {
+        float target[MAX_N_AXIS];
+        copyAxes(target, gc_state.position);
+        target[Z_AXIS] = z + get_wco()[Z_AXIS];
+
+        plan_line_data_t plan_data      = {};
+        plan_data.motion.noFeedOverride = 1;
+        plan_data.spindle               = SpindleState::Disable;
+        plan_data.feed_rate             = feed;
+        plan_data.line_number           = gc_state.line_number;
+
+        // The planner still drains before each probe, since the probe must
+        // start from rest; only the per-point report is dropped.
+        mc_probe_cycle(target, &plan_data, false, false, 0, __FLT_MAX__, false);
+        gc_sync_position();
+        if (sys.abort || !probe_succeeded) {
+            return false;
+        }
+        float contact[MAX_N_AXIS];
+        motor_steps_to_mpos(contact, probe_steps);
+        height = contact[Z_AXIS] - get_wco()[Z_AXIS];
+        return true;
+    }
+}
+
+Error probe_grid(const char* value) {
+    GridArgs args;
+    if (!value || !parse(value, args)) {
+        log_error("$Probe/Grid needs X Y I J C R Z H F S, like $Probe/Grid=X0 Y0 I10 J10 C20 R20 Z-5 H3 F100 S2000 [file]");
+        return Error::InvalidStatement;
+    }
+    if (!config->_probe->exists()) {
+        log_error("Probe pin is not configured");
+        return Error::InvalidStatement;
+    }
+    int columns = int(args.columns);
+    int rows    = int(args.rows);
+    if (columns < 1 || rows < 1 || columns > 0xFFFF || rows > 0xFFFF || args.probe_feed <= 0 || args.travel_feed <= 0 || args.z >= args.h) {
+        return Error::InvalidValue;
+    }
+
+    std::vector<float> heights;
+    heights.reserve(columns * rows);
+
+    gc_sync_position();
+    float* wco = get_wco();
+    if (!travel(gc_state.position[X_AXIS] - wco[X_AXIS], gc_state.position[Y_AXIS] - wco[Y_AXIS], args.h, args.travel_feed)) {
+        return Error::Reset;
+    }
+
+    std::vector<float> row(columns);
+    for (int r = 0; r < rows; r++) {
+        // Serpentine, so each row starts where the last one ended
+        bool  reverse = r & 1;
+        float y       = args.y + r * args.dy;
+        for (int i = 0; i < columns; i++) {
+            int   c = reverse ? columns - 1 - i : i;
+            float x = args.x + c * args.dx;
+            if (!travel(x, y, args.h, args.travel_feed)) {
+                return Error::Reset;
+            }
+            float height;
+            if (!probe(args.z, args.probe_feed, height)) {
+                log_error("Probe grid stopped at column " << c << " row " << r);
+                return sys.abort ? Error::Reset : Error::InvalidStatement;
+            }
+            row[c] = height;
+            if (!travel(x, y, args.h, args.travel_feed)) {
+                return Error::Reset;
+            }
+        }
+        heights.insert(heights.end(), row.begin(), row.end());
+        log_info("Probe grid row " << (r + 1) << " of " << rows);
+    }
+    protocol_buffer_synchronize();
+
+    auto minmax = std::minmax_element(heights.begin(), heights.end());
+    log_info("Probe grid Z min:" << *minmax.first << " max:" << *minmax.second);
+
+    heightmap_header_t header = {};
+    memcpy(header.magic, "FNHM", 4);
+    header.version = 1;
+    header.columns = columns;
+    header.rows    = rows;
+    header.x0      = args.x;
+    header.y0      = args.y;
+    header.dx      = args.dx;
+    header.dy      = args.dy;
+
+    try {
+        FileStream file(args.file, "w", "");
+        file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const uint8_t*>(heights.data()), heights.size() * sizeof(float));
+        log_info("Probe grid saved to " << file.path());
+    } catch (Error err) { return err; }
+    return Error::Ok;
+}
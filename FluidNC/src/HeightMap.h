@@ -0,0 +1,37 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  Grid probing for surface height maps.
+
+  $Probe/Grid=X<x> Y<y> I<dx> J<dy> C<columns> R<rows> Z<z> H<h> F<feed> S<feed> [file]
+
+  probes a grid of columns by rows points, starting at X,Y and spaced by
+  I along X and J along Y, all in work coordinates and millimeters.  At
+  each point the probe goes down toward Z at feed F; between points it
+  travels at height H at feed S.  The rows are probed in alternate
+  directions.  The travel moves are queued behind each other, so only
+  the probe moves wait for the planner to empty.
+
+  The contact heights, in work coordinates, are written to the file,
+  heightmap.bin on the local filesystem by default, as a heightmap_header_t
+  followed by rows * columns little-endian floats, row by row from Y.
+  Points whose probe does not touch stop the survey with an alarm.
+*/
+
+#include "Error.h"
+
+#include <cstdint>
+
+struct heightmap_header_t {
+    char     magic[4];  // "FNHM"
+    uint16_t version;   // 1
+    uint16_t columns;
+    uint16_t rows;
+    uint16_t reserved;
+    float    x0, y0;  // Work coordinates of the first point
+    float    dx, dy;  // Spacing
+};
+
+Error probe_grid(const char* value);
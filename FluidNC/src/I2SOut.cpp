@@ -16,6 +16,8 @@ uint8_t i2s_out_read(pinnum_t pin) {
 }
 void i2s_out_write(pinnum_t pin, uint8_t val) {}
 void i2s_out_push_sample(uint32_t usec) {}
+void i2s_out_burst_step(pinnum_t pin, const uint8_t* events, size_t count) {}
+void i2s_out_start_burst(uint32_t events, uint32_t pulse_usec) {}
 void i2s_out_push() {}
 void i2s_out_delay() {}
 
@@ -37,6 +39,9 @@ int i2s_out_reset() {
 int i2s_out_init() {
     return -1;
 }
+void i2s_out_get_stats(i2s_out_stats_t& stats) {
+    stats = { 0, 0, 0, UINT32_MAX };
+}
 #else
 #    include "Config.h"
 #    include "Pin.h"
@@ -54,6 +59,7 @@ int i2s_out_init() {
 #    include <freertos/queue.h>
 #    include <soc/gpio_periph.h>
 #    include "Driver/fluidnc_gpio.h"
+#    include "Driver/delay_usecs.h"  // getCpuTicks
 
 // The <atomic> library routines are not in IRAM so they can crash when called from FLASH
 // The GCC intrinsic versions which are prefixed with __ are compiled inline
@@ -80,22 +86,34 @@ static std::atomic<std::uint32_t> i2s_out_port_data = ATOMIC_VAR_INIT(0);
 //
 // Configrations for DMA connected I2S
 //
-// One DMA buffer transfer takes about 2 ms
-//   I2S_OUT_DMABUF_LEN / I2S_SAMPLE_SIZE x I2S_OUT_USEC_PER_PULSE
+// With the default i2so: settings, one DMA buffer transfer takes about 2 ms
+//   dma_buffer_bytes / I2S_SAMPLE_SIZE x sample_us
 //   = 2000 / 4 x 4
 //   = 2000us = 2ms
-// If I2S_OUT_DMABUF_COUNT is 5, it will take about 10 ms for all the DMA buffer transfers to finish.
+// If dma_buffer_count is 5, it will take about 10 ms for all the DMA buffer transfers to finish.
 //
-// Increasing I2S_OUT_DMABUF_COUNT has the effect of preventing buffer underflow,
+// Increasing dma_buffer_count has the effect of preventing buffer underflow,
 // but on the other hand, it leads to a delay with pulse and/or non-pulse-generated I/Os.
-// The number of I2S_OUT_DMABUF_COUNT should be chosen carefully.
+// The number of dma_buffer_count should be chosen carefully.
 //
 // Reference information:
 //   FreeRTOS task time slice = portTICK_PERIOD_MS = 1 ms (ESP32 FreeRTOS port)
 //
-const int I2S_SAMPLE_SIZE   = 4;                                    /* 4 bytes, 32 bits per sample */
-const int DMA_SAMPLE_COUNT  = I2S_OUT_DMABUF_LEN / I2S_SAMPLE_SIZE; /* number of samples per buffer */
-const int SAMPLE_SAFE_COUNT = (20 / I2S_OUT_USEC_PER_PULSE);        /* prevent buffer overrun ($0 should be less than or equal 20) */
+const int I2S_SAMPLE_SIZE = 4; /* 4 bytes, 32 bits per sample */
+
+// Set from the i2so: config by i2s_out_init()
+static uint32_t i2s_out_usec_per_pulse  = I2S_OUT_USEC_PER_PULSE;
+static uint32_t i2s_out_dmabuf_count    = I2S_OUT_DMABUF_COUNT;
+static uint32_t i2s_out_dmabuf_len      = I2S_OUT_DMABUF_LEN;
+static uint32_t dma_sample_count        = I2S_OUT_DMABUF_LEN / I2S_SAMPLE_SIZE; /* number of samples per buffer */
+static uint32_t sample_safe_count       = 5;  /* prevent buffer overrun ($0 should be less than or equal 20) */
+static uint32_t i2s_out_delay_dmabuf_ms = 2;
+static uint32_t i2s_out_delay_ms        = 12;
+
+static volatile uint32_t i2s_out_underruns    = 0;
+static uint32_t          i2s_out_late_buffers = 0;
+static uint32_t          i2s_out_max_fill_us  = 0;
+static uint32_t          i2s_out_min_slack_us = UINT32_MAX;
 
 typedef struct {
     uint32_t**   buffers;
@@ -134,6 +152,14 @@ static int i2s_out_initialized = 0;
 static volatile uint32_t i2s_out_pulse_period;
 static uint32_t          i2s_out_remain_time_until_next_pulse;  // Time remaining until the next pulse (μsec)
 
+// The burst the I2S task is sending: the step pins, as port bits, that
+// pulse at each event, and the next event to send.  Only the I2S task
+// and, under the pulser lock, reset and set_stepping touch these.
+static uint32_t i2s_burst_bits[Machine::Stepping::maxBurstEvents];
+static uint32_t i2s_burst_events        = 0;
+static uint32_t i2s_burst_next          = 0;
+static uint32_t i2s_burst_pulse_samples = 1;
+
 static pinnum_t i2s_out_ws_pin   = 255;
 static pinnum_t i2s_out_bck_pin  = 255;
 static pinnum_t i2s_out_data_pin = 255;
@@ -188,28 +214,49 @@ static inline void i2s_out_reset_fifo_without_lock() {
     I2S0.conf.tx_fifo_reset = 0;
 }
 
-static int i2s_clear_dma_buffer(lldesc_t* dma_desc, uint32_t port_data) {
-    uint32_t* buf = (uint32_t*)dma_desc->buf;
-    for (int i = 0; i < DMA_SAMPLE_COUNT; i++) {
-        buf[i] = port_data;
+// Write count copies of a sample.  The runs between step pulses are
+// hundreds of samples long at low step rates, so unroll by four.
+static inline void IRAM_ATTR i2s_fill_samples(uint32_t* buf, uint32_t sample, uint32_t count) {
+    uint32_t* end = buf + count;
+    for (; end - buf >= 4; buf += 4) {
+        buf[0] = sample;
+        buf[1] = sample;
+        buf[2] = sample;
+        buf[3] = sample;
+    }
+    while (buf < end) {
+        *buf++ = sample;
     }
+}
+
+// Drop what is left of the burst being sent
+static void IRAM_ATTR i2s_burst_clear() {
+    for (uint32_t i = 0; i < Machine::Stepping::maxBurstEvents; i++) {
+        i2s_burst_bits[i] = 0;
+    }
+    i2s_burst_events = 0;
+    i2s_burst_next   = 0;
+}
+
+static int i2s_clear_dma_buffer(lldesc_t* dma_desc, uint32_t port_data) {
+    i2s_fill_samples((uint32_t*)dma_desc->buf, port_data, dma_sample_count);
     // Restore the buffer length.
     // The length may have been changed short when the data was filled in to prevent buffer overrun.
-    dma_desc->length = I2S_OUT_DMABUF_LEN;
+    dma_desc->length = i2s_out_dmabuf_len;
     return 0;
 }
 
 static int i2s_clear_o_dma_buffers(uint32_t port_data) {
-    for (int buf_idx = 0; buf_idx < I2S_OUT_DMABUF_COUNT; buf_idx++) {
+    for (uint32_t buf_idx = 0; buf_idx < i2s_out_dmabuf_count; buf_idx++) {
         // Initialize DMA descriptor
         o_dma.desc[buf_idx]->owner        = 1;
         o_dma.desc[buf_idx]->eof          = 1;  // set to 1 will trigger the interrupt
         o_dma.desc[buf_idx]->sosf         = 0;
-        o_dma.desc[buf_idx]->length       = I2S_OUT_DMABUF_LEN;
-        o_dma.desc[buf_idx]->size         = I2S_OUT_DMABUF_LEN;
+        o_dma.desc[buf_idx]->length       = i2s_out_dmabuf_len;
+        o_dma.desc[buf_idx]->size         = i2s_out_dmabuf_len;
         o_dma.desc[buf_idx]->buf          = (uint8_t*)o_dma.buffers[buf_idx];
         o_dma.desc[buf_idx]->offset       = 0;
-        o_dma.desc[buf_idx]->qe.stqe_next = (lldesc_t*)((buf_idx < (I2S_OUT_DMABUF_COUNT - 1)) ? (o_dma.desc[buf_idx + 1]) : o_dma.desc[0]);
+        o_dma.desc[buf_idx]->qe.stqe_next = (lldesc_t*)((buf_idx < (i2s_out_dmabuf_count - 1)) ? (o_dma.desc[buf_idx + 1]) : o_dma.desc[0]);
         i2s_clear_dma_buffer(o_dma.desc[buf_idx], port_data);
     }
     return 0;
@@ -354,42 +401,64 @@ static int i2s_fillout_dma_buffer(lldesc_t* dma_desc) {
         // the generation of the buffer is interrupted (the buffer length is shortened slightly)
         // and the pulse generation is postponed until the next buffer is filled.
         //
-        o_dma.rw_pos = 0;
-        while (o_dma.rw_pos < (DMA_SAMPLE_COUNT - SAMPLE_SAFE_COUNT)) {
+        // Stepper::pulse_func() traces a burst of step events at a time and
+        // marks the step pins of each.  The events are sent one pulse period
+        // apart, and the samples between them are written a run at a time,
+        // from one read of the port data.
+        //
+        const uint32_t fill_limit = dma_sample_count - sample_safe_count;
+        o_dma.rw_pos              = 0;
+        while (o_dma.rw_pos < fill_limit) {
             // no data to read (buffer empty)
-            if (i2s_out_remain_time_until_next_pulse < I2S_OUT_USEC_PER_PULSE) {
+            if (i2s_out_remain_time_until_next_pulse < i2s_out_usec_per_pulse) {
                 // pulser status may change in pulse phase func, so I need to check it every time.
                 if (i2s_out_pulser_status == STEPPING) {
                     // fillout future DMA buffer (tail of the DMA buffer chains)
                     uint32_t old_rw_pos = o_dma.rw_pos;
-                    I2S_OUT_PULSER_EXIT_CRITICAL();  // Temporarily unlocked status lock as it may be locked in pulse callback.
-                    Stepper::pulse_func();
-
-                    I2S_OUT_PULSER_ENTER_CRITICAL();  // Lock again.
-                    // Calculate pulse period.
-                    i2s_out_remain_time_until_next_pulse += i2s_out_pulse_period - I2S_OUT_USEC_PER_PULSE * (o_dma.rw_pos - old_rw_pos);
-                    if (i2s_out_pulser_status == WAITING) {
-                        // i2s_out_set_passthrough() has called from the pulse function.
-                        // It needs to go into pass-through mode.
-                        // This DMA descriptor must be a tail of the chain.
-                        dma_desc->qe.stqe_next = NULL;  // Cut the DMA descriptor ring. This allow us to identify the tail of the buffer.
-                    } else if (i2s_out_pulser_status == PASSTHROUGH) {
-                        // i2s_out_reset() has called during the execution of the pulse function.
-                        // I2S has already in static mode, and buffers has cleared to zero.
-                        // To prevent the pulse function from being called back,
-                        // we assume that the buffer is already full.
-                        i2s_out_remain_time_until_next_pulse = 0;                 // There is no need to fill the current buffer.
-                        o_dma.rw_pos                         = DMA_SAMPLE_COUNT;  // The buffer is full.
-                        break;
+                    if (i2s_burst_next == i2s_burst_events) {
+                        // The last burst has gone out, so trace the next one
+                        I2S_OUT_PULSER_EXIT_CRITICAL();  // Temporarily unlocked status lock as it may be locked in pulse callback.
+                        Stepper::pulse_func();
+
+                        I2S_OUT_PULSER_ENTER_CRITICAL();  // Lock again.
+                        if (i2s_out_pulser_status == WAITING) {
+                            // i2s_out_set_passthrough() has called from the pulse function.
+                            // It needs to go into pass-through mode.
+                            // This DMA descriptor must be a tail of the chain.
+                            // Cut the DMA descriptor ring. This allow us to identify the tail of the buffer.
+                            dma_desc->qe.stqe_next = NULL;
+                        } else if (i2s_out_pulser_status == PASSTHROUGH) {
+                            // i2s_out_reset() has called during the execution of the pulse function.
+                            // I2S has already in static mode, and buffers has cleared to zero.
+                            // To prevent the pulse function from being called back,
+                            // we assume that the buffer is already full.
+                            i2s_out_remain_time_until_next_pulse = 0;                 // There is no need to fill the current buffer.
+                            o_dma.rw_pos                         = dma_sample_count;  // The buffer is full.
+                            break;
+                        }
+                    }
+                    if (i2s_burst_next < i2s_burst_events) {
+                        // Send the burst's next step event
+                        uint32_t port_data = ATOMIC_LOAD(&i2s_out_port_data) ^ i2s_burst_bits[i2s_burst_next];
+                        i2s_burst_bits[i2s_burst_next++] = 0;
+                        i2s_fill_samples(&buf[o_dma.rw_pos], port_data, i2s_burst_pulse_samples);
+                        o_dma.rw_pos += i2s_burst_pulse_samples;
                     }
+                    // Calculate pulse period.
+                    i2s_out_remain_time_until_next_pulse += i2s_out_pulse_period - i2s_out_usec_per_pulse * (o_dma.rw_pos - old_rw_pos);
                     continue;
                 }
             }
             // no pulse data in push buffer (pulse off or idle or callback is not defined)
-            buf[o_dma.rw_pos++] = ATOMIC_LOAD(&i2s_out_port_data);
-            if (i2s_out_remain_time_until_next_pulse >= I2S_OUT_USEC_PER_PULSE) {
-                i2s_out_remain_time_until_next_pulse -= I2S_OUT_USEC_PER_PULSE;
+            // Fill up to the next pulse, or the rest of the buffer if there is none
+            uint32_t run = i2s_out_remain_time_until_next_pulse / i2s_out_usec_per_pulse;
+            if (run == 0 || run > fill_limit - o_dma.rw_pos) {
+                run = fill_limit - o_dma.rw_pos;
             }
+            i2s_fill_samples(&buf[o_dma.rw_pos], ATOMIC_LOAD(&i2s_out_port_data), run);
+            o_dma.rw_pos += run;
+            uint32_t elapsed = run * i2s_out_usec_per_pulse;
+            i2s_out_remain_time_until_next_pulse = elapsed < i2s_out_remain_time_until_next_pulse ? i2s_out_remain_time_until_next_pulse - elapsed : 0;
         }
         // set filled length to the DMA descriptor
         dma_desc->length = o_dma.rw_pos * I2S_SAMPLE_SIZE;
@@ -433,6 +502,7 @@ static void IRAM_ATTR i2s_out_intr_handler(void* arg) {
         // If the queue is full it's because we have an underflow,
         // more than buf_count isr without new data, remove the front buffer
         if (xQueueIsQueueFullFromISR(o_dma.queue)) {
+            ++i2s_out_underruns;
             lldesc_t* front_desc;
             // Remove a descriptor from the DMA complete event queue
             xQueueReceiveFromISR(o_dma.queue, &front_desc, &high_priority_task_awoken);
@@ -446,11 +516,11 @@ static void IRAM_ATTR i2s_out_intr_handler(void* arg) {
             // lldesc_t.buf is const for S2.  Perhaps we can get by
             // without replacing the data in the buffer since we are
             // already in an error situation.
-            for (int i = 0; i < DMA_SAMPLE_COUNT; i++) {
+            for (uint32_t i = 0; i < dma_sample_count; i++) {
                 front_desc->buf[i] = port_data;
             }
 #    endif
-            front_desc->length = I2S_OUT_DMABUF_LEN;
+            front_desc->length = i2s_out_dmabuf_len;
         }
 
         // Send a DMA complete event to the I2S bitstreamer task with finished buffer
@@ -465,6 +535,26 @@ static void IRAM_ATTR i2s_out_intr_handler(void* arg) {
     I2S0.int_clr.val = I2S0.int_st.val;  //clear pending interrupt
 }
 
+// Record how long a buffer took to fill and how much time was left
+// before the DMA needs it.  The buffers still waiting in the queue have
+// already been played, so the DMA has the others, less the one it is
+// partway through, ahead of this one.
+static void i2s_out_account_fill(int32_t fill_start) {
+    uint32_t fill_us = (getCpuTicks() - fill_start) / ticks_per_us;
+    if (fill_us > i2s_out_max_fill_us) {
+        i2s_out_max_fill_us = fill_us;
+    }
+    uint32_t waiting  = uxQueueMessagesWaiting(o_dma.queue);
+    uint32_t ahead    = waiting < i2s_out_dmabuf_count - 1 ? i2s_out_dmabuf_count - 1 - waiting : 0;
+    uint32_t slack_us = ahead > 1 ? (ahead - 1) * (dma_sample_count - sample_safe_count) * i2s_out_usec_per_pulse : 0;
+    if (ahead <= 1) {
+        ++i2s_out_late_buffers;
+    }
+    if (slack_us < i2s_out_min_slack_us) {
+        i2s_out_min_slack_us = slack_us;
+    }
+}
+
 //
 // I2S bitstream generator task
 //
@@ -489,8 +579,10 @@ static void i2sOutTask(void* parameter) {
             // the generation of the buffer is interrupted (the buffer length is shortened slightly)
             // and the pulse generation is postponed until the next buffer is filled.
             //
+            int32_t fill_start = getCpuTicks();
             i2s_fillout_dma_buffer(dma_desc);
             dma_desc->length = o_dma.rw_pos * I2S_SAMPLE_SIZE;
+            i2s_out_account_fill(fill_start);
         } else if (i2s_out_pulser_status == WAITING) {
             if (dma_desc->qe.stqe_next == NULL) {
                 // Tail of the DMA descriptor found
@@ -531,12 +623,12 @@ void i2s_out_delay() {
     if (i2s_out_pulser_status == PASSTHROUGH) {
         // Depending on the timing, it may not be reflected immediately,
         // so wait twice as long just in case.
-        delay_us(I2S_OUT_USEC_PER_PULSE * 2);
+        delay_us(i2s_out_usec_per_pulse * 2);
     } else {
         // Just wait until the data now registered in the DMA descripter
         // is reflected in the I2S TX module via FIFO.
         // XXX perhaps just wait until I2SO.conf1.tx_start == 0
-        delay_ms(I2S_OUT_DELAY_MS);
+        delay_ms(i2s_out_delay_ms);
     }
     I2S_OUT_PULSER_EXIT_CRITICAL();
 }
@@ -556,19 +648,43 @@ uint8_t i2s_out_read(pinnum_t pin) {
 }
 
 void IRAM_ATTR i2s_out_push_sample(uint32_t usec) {
-    int32_t num = usec / I2S_OUT_USEC_PER_PULSE;
+    uint32_t num = usec / i2s_out_usec_per_pulse;
 
-    if (num > SAMPLE_SAFE_COUNT) {
+    if (num > sample_safe_count) {
         return;
     }
     // push at least one sample, even if num is zero)
     if (num == 0) {
         num = 1;
     }
-    uint32_t port_data = ATOMIC_LOAD(&i2s_out_port_data);
-    do {
-        o_dma.current[o_dma.rw_pos++] = port_data;
-    } while (--num);
+    i2s_fill_samples(&o_dma.current[o_dma.rw_pos], ATOMIC_LOAD(&i2s_out_port_data), num);
+    o_dma.rw_pos += num;
+}
+
+// Called from Stepper::pulse_func() in the I2S task, so the burst is not
+// being sent.  Inverted pins are idle high, so the event's bits toggle.
+void IRAM_ATTR i2s_out_burst_step(pinnum_t pin, const uint8_t* events, size_t count) {
+    uint32_t bit = bitnum_to_mask(pin);
+    for (size_t i = 0; i < count; i++) {
+        i2s_burst_bits[events[i]] |= bit;
+    }
+}
+
+void IRAM_ATTR i2s_out_start_burst(uint32_t events, uint32_t pulse_usec) {
+    uint32_t num = pulse_usec / i2s_out_usec_per_pulse;
+    // at least one sample, as in i2s_out_push_sample()
+    i2s_burst_pulse_samples = num ? num : 1;
+    i2s_burst_next          = 0;
+    i2s_burst_events        = events;
+}
+
+void i2s_out_get_stats(i2s_out_stats_t& stats) {
+    I2S_OUT_PULSER_ENTER_CRITICAL();
+    stats.underruns    = i2s_out_underruns;
+    stats.late_buffers = i2s_out_late_buffers;
+    stats.max_fill_us  = i2s_out_max_fill_us;
+    stats.min_slack_us = i2s_out_min_slack_us;
+    I2S_OUT_PULSER_EXIT_CRITICAL();
 }
 
 i2s_out_pulser_status_t i2s_out_get_pulser_status() {
@@ -606,7 +722,7 @@ int i2s_out_set_stepping() {
         // Wait for complete DMAs
         for (;;) {
             I2S_OUT_PULSER_EXIT_CRITICAL();
-            delay_ms(I2S_OUT_DELAY_DMABUF_MS);
+            delay_ms(i2s_out_delay_dmabuf_ms);
             I2S_OUT_PULSER_ENTER_CRITICAL();
             if (i2s_out_pulser_status == WAITING) {
                 continue;
@@ -624,6 +740,7 @@ int i2s_out_set_stepping() {
 
     // Change I2S state from PASSTHROUGH to STEPPING
     i2s_out_stop();
+    i2s_burst_clear();
     uint32_t port_data = ATOMIC_LOAD(&i2s_out_port_data);
     i2s_clear_o_dma_buffers(port_data);
 
@@ -643,6 +760,7 @@ int IRAM_ATTR i2s_out_set_pulse_period(uint32_t period) {
 int i2s_out_reset() {
     I2S_OUT_PULSER_ENTER_CRITICAL();
     i2s_out_stop();
+    i2s_burst_clear();
     if (i2s_out_pulser_status == STEPPING) {
         uint32_t port_data = ATOMIC_LOAD(&i2s_out_port_data);
         i2s_clear_o_dma_buffers(port_data);
@@ -669,6 +787,17 @@ int i2s_out_init(i2s_out_init_t& init_param) {
 
     ATOMIC_STORE(&i2s_out_port_data, init_param.init_val);
 
+    // Stream timing and DMA buffer geometry
+    i2s_out_usec_per_pulse = init_param.usec_per_pulse;
+    i2s_out_dmabuf_len     = init_param.dmabuf_len;
+    i2s_out_dmabuf_count   = init_param.dmabuf_count;
+    dma_sample_count       = i2s_out_dmabuf_len / I2S_SAMPLE_SIZE;
+    sample_safe_count      = (I2S_STREAM_MAX_USEC_PER_PULSE + i2s_out_usec_per_pulse - 1) / i2s_out_usec_per_pulse;
+
+    uint32_t dmabuf_us      = dma_sample_count * i2s_out_usec_per_pulse;
+    i2s_out_delay_dmabuf_ms = (dmabuf_us + 999) / 1000;
+    i2s_out_delay_ms        = i2s_out_delay_dmabuf_ms * (i2s_out_dmabuf_count + 1);
+
     // To make sure hardware is enabled before any hardware register operations.
     periph_module_reset(PERIPH_I2S0_MODULE);
     periph_module_enable(PERIPH_I2S0_MODULE);
@@ -702,27 +831,27 @@ int i2s_out_init(i2s_out_init_t& init_param) {
    */
 
     // Allocate the array of pointers to the buffers
-    o_dma.buffers = (uint32_t**)malloc(sizeof(uint32_t*) * I2S_OUT_DMABUF_COUNT);
+    o_dma.buffers = (uint32_t**)malloc(sizeof(uint32_t*) * i2s_out_dmabuf_count);
     if (o_dma.buffers == nullptr) {
         return -1;
     }
 
     // Allocate each buffer that can be used by the DMA controller
-    for (int buf_idx = 0; buf_idx < I2S_OUT_DMABUF_COUNT; buf_idx++) {
-        o_dma.buffers[buf_idx] = (uint32_t*)heap_caps_calloc(1, I2S_OUT_DMABUF_LEN, MALLOC_CAP_DMA);
+    for (uint32_t buf_idx = 0; buf_idx < i2s_out_dmabuf_count; buf_idx++) {
+        o_dma.buffers[buf_idx] = (uint32_t*)heap_caps_calloc(1, i2s_out_dmabuf_len, MALLOC_CAP_DMA);
         if (o_dma.buffers[buf_idx] == nullptr) {
             return -1;
         }
     }
 
     // Allocate the array of DMA descriptors
-    o_dma.desc = (lldesc_t**)malloc(sizeof(lldesc_t*) * I2S_OUT_DMABUF_COUNT);
+    o_dma.desc = (lldesc_t**)malloc(sizeof(lldesc_t*) * i2s_out_dmabuf_count);
     if (o_dma.desc == nullptr) {
         return -1;
     }
 
     // Allocate each DMA descriptor that will be used by the DMA controller
-    for (int buf_idx = 0; buf_idx < I2S_OUT_DMABUF_COUNT; buf_idx++) {
+    for (uint32_t buf_idx = 0; buf_idx < i2s_out_dmabuf_count; buf_idx++) {
         o_dma.desc[buf_idx] = (lldesc_t*)heap_caps_malloc(sizeof(lldesc_t), MALLOC_CAP_DMA);
         if (o_dma.desc[buf_idx] == nullptr) {
             return -1;
@@ -733,7 +862,7 @@ int i2s_out_init(i2s_out_init_t& init_param) {
     i2s_clear_o_dma_buffers(init_param.init_val);
     o_dma.rw_pos  = 0;
     o_dma.current = NULL;
-    o_dma.queue   = xQueueCreate(I2S_OUT_DMABUF_COUNT, sizeof(uint32_t*));
+    o_dma.queue   = xQueueCreate(i2s_out_dmabuf_count, sizeof(uint32_t*));
 
     // Set the first DMA descriptor
     I2S0.out_link.addr = (uint32_t)o_dma.desc[0];
@@ -841,24 +970,17 @@ int i2s_out_init(i2s_out_init_t& init_param) {
     // i2s_set_clk
     //
 
-    // set clock (fi2s) 160MHz / 5
+    // set clock (fi2s) 160MHz / (N + b/a)
 #    ifdef CONFIG_IDF_TARGET_ESP32
     // i2s_ll_rx_clk_set_src(dev, I2S_CLK_D2CLK);
     I2S0.clkm_conf.clka_en = 0;  // Use 160 MHz PLL_D2_CLK as reference
 #    endif
-        // N + b/a = 0
-#    if I2S_OUT_NUM_BITS == 16
-    // N = 10
-    I2S0.clkm_conf.clkm_div_num = 10;  // minimum value of 2, reset value of 4, max 256 (I²S clock divider’s integral value)
-#    else
-    // N = 5
-    // 5 could be changed to 2 to make I2SO pulse at 312.5 kHZ instead of 125 kHz, but doing so would
-    // require some changes to deal with pulse lengths that are not an integral number of microseconds.
-    I2S0.clkm_conf.clkm_div_num = 5;  // minimum value of 2, reset value of 4, max 256 (I²S clock divider’s integral value)
-#    endif
-    // b/a = 0
-    I2S0.clkm_conf.clkm_div_b = 0;  // 0 at reset
-    I2S0.clkm_conf.clkm_div_a = 0;  // 0 at reset, what about divide by 0? (not an issue)
+    // N + b/a follows sample_us; the default 4 us is N = 10 for 16 bits and N = 5 for 32 bits.
+    // A fractional divider, when sample_us needs one, alternates between N and N + 1.
+    uint32_t quarters           = i2s_out_clock_quarters(i2s_out_usec_per_pulse);
+    I2S0.clkm_conf.clkm_div_num = quarters / 4;  // minimum value of 2, reset value of 4, max 256 (I²S clock divider’s integral value)
+    I2S0.clkm_conf.clkm_div_b   = quarters % 4;  // 0 at reset
+    I2S0.clkm_conf.clkm_div_a   = 4;             // 0 at reset; only used when b is nonzero
 
     // Bit clock configuration bit in transmitter mode.
     // fbck = fi2s / tx_bck_div_num = (160 MHz / 5) / 2 = 16 MHz
@@ -930,11 +1052,14 @@ int i2s_out_init() {
         return -1;
     } else {
         i2s_out_init_t default_param;
-        default_param.ws_pin       = wsPin.getNative(Pin::Capabilities::Output | Pin::Capabilities::Native);
-        default_param.bck_pin      = bckPin.getNative(Pin::Capabilities::Output | Pin::Capabilities::Native);
-        default_param.data_pin     = dataPin.getNative(Pin::Capabilities::Output | Pin::Capabilities::Native);
-        default_param.pulse_period = I2S_OUT_USEC_PER_PULSE;
-        default_param.init_val     = I2S_OUT_INIT_VAL;
+        default_param.ws_pin         = wsPin.getNative(Pin::Capabilities::Output | Pin::Capabilities::Native);
+        default_param.bck_pin        = bckPin.getNative(Pin::Capabilities::Output | Pin::Capabilities::Native);
+        default_param.data_pin       = dataPin.getNative(Pin::Capabilities::Output | Pin::Capabilities::Native);
+        default_param.pulse_period   = i2so->_sample_us;
+        default_param.init_val       = I2S_OUT_INIT_VAL;
+        default_param.usec_per_pulse = i2so->_sample_us;
+        default_param.dmabuf_len     = i2so->_dma_buffer_bytes;
+        default_param.dmabuf_count   = i2so->_dma_buffer_count;
 
         return i2s_out_init(default_param);
     }
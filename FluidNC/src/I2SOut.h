@@ -24,20 +24,26 @@
 
 /* 16-bit mode: 1000000 usec / ((160000000 Hz) / 10 / 2) x 16 bit/pulse x 2(stereo) = 4 usec/pulse */
 /* 32-bit mode: 1000000 usec / ((160000000 Hz) /  5 / 2) x 32 bit/pulse x 2(stereo) = 4 usec/pulse */
+/* Defaults for the i2so: sample_us, dma_buffer_bytes and dma_buffer_count items */
 const uint32_t I2S_OUT_USEC_PER_PULSE = 4;
+const uint32_t I2S_OUT_DMABUF_COUNT   = 5;    /* number of DMA buffers to store data */
+const uint32_t I2S_OUT_DMABUF_LEN     = 2000; /* maximum size in bytes (4092 is DMA's limit) */
+
+const uint32_t I2S_OUT_DMABUF_MAX_LEN = 4092;
+
+// The I2S clock divider N + b/a, in quarters, that gives one sample every
+// usec_per_pulse microseconds: 160 MHz / (N + b/a) / 2 / (I2S_OUT_NUM_BITS x 2).
+// The divider's integral part N must be between 2 and 255.
+constexpr uint32_t i2s_out_clock_quarters(uint32_t usec_per_pulse) {
+    return usec_per_pulse * 160 / I2S_OUT_NUM_BITS;
+}
+const uint32_t I2S_OUT_MIN_USEC_PER_PULSE = (2 * 4 * I2S_OUT_NUM_BITS + 159) / 160;
+const uint32_t I2S_OUT_MAX_USEC_PER_PULSE = (255 * 4 + 3) * I2S_OUT_NUM_BITS / 160;
 
 // This value is empirically determined.  It might depend on I2S_OUT_USEC_PULSE but
 // the root cause of the limitation has not been analyzed so that is just a guess.
 const uint32_t I2S_STREAM_MAX_USEC_PER_PULSE = 20;
 
-constexpr uint32_t i2s_out_max_steps_per_sec = 1000000 / (2 * I2S_OUT_USEC_PER_PULSE);
-
-const int I2S_OUT_DMABUF_COUNT = 5;    /* number of DMA buffers to store data */
-const int I2S_OUT_DMABUF_LEN   = 2000; /* maximum size in bytes (4092 is DMA's limit) */
-
-const int I2S_OUT_DELAY_DMABUF_MS = (I2S_OUT_DMABUF_LEN / sizeof(uint32_t) * I2S_OUT_USEC_PER_PULSE / 1000);
-const int I2S_OUT_DELAY_MS        = (I2S_OUT_DELAY_DMABUF_MS * (I2S_OUT_DMABUF_COUNT + 1));
-
 typedef struct {
     /*
         I2S bitstream (32-bits): Transfers from MSB(bit31) to LSB(bit0) in sequence
@@ -57,6 +63,9 @@ typedef struct {
     pinnum_t data_pin;
     uint32_t pulse_period;  // aka step rate.
     uint32_t init_val;
+    uint32_t usec_per_pulse;  // Sample period
+    uint32_t dmabuf_len;      // Bytes per DMA buffer
+    uint32_t dmabuf_count;
 } i2s_out_init_t;
 
 /*
@@ -73,6 +82,7 @@ int i2s_out_init(i2s_out_init_t& init_param);
         .data_pin = I2S_OUT_DATA,
         .pulse_period = I2S_OUT_USEC_PER_PULSE,
         .init_val = I2S_OUT_INIT_VAL,
+        .usec_per_pulse, .dmabuf_len and .dmabuf_count from the i2so: config
     };
   return -1 ... already initialized
 */
@@ -95,16 +105,26 @@ void i2s_out_write(pinnum_t pin, uint8_t val);
 
 /*
     Set current pin state to the I2S bitstream buffer
-    (This call will generate a future I2S_OUT_USEC_PER_PULSE μs x N bitstream)
+    (This call will generate a future sample_us μs x N bitstream)
     usec: The length of time that the pulse should be repeated.
          That time will be converted to an integer number of pulses of
-         length I2S_OUT_USEC_PER_PULSE.
-         The number of samples is limited to (20 / I2S_OUT_USEC_PER_PULSE).
+         length sample_us.
+         The number of samples is limited to (20 / sample_us), rounded up.
     return: number of pushed samples
             0 .. no space for push
  */
 void i2s_out_push_sample(uint32_t usec);
 
+/*
+   Step events of an I2S_STREAM burst, for Stepper::pulse_func().
+   i2s_out_burst_step() marks the events, numbered from 0, at which
+   a step pin pulses.  i2s_out_start_burst() hands the marked events
+   to the I2S task, which sends them one pulse period apart, each as
+   pulse_usec of samples with the marked pins active.
+ */
+void i2s_out_burst_step(pinnum_t pin, const uint8_t* events, size_t count);
+void i2s_out_start_burst(uint32_t events, uint32_t pulse_usec);
+
 /*
    Set pulser mode to passtrough
    After this function is called,
@@ -150,6 +170,17 @@ i2s_out_pulser_status_t IRAM_ATTR i2s_out_get_pulser_status();
  */
 int i2s_out_reset();
 
+/*
+   Stream health counters, since startup
+ */
+struct i2s_out_stats_t {
+    uint32_t underruns;     // The DMA reached a buffer that had not been refilled
+    uint32_t late_buffers;  // A buffer was refilled with less than one buffer time to spare
+    uint32_t max_fill_us;   // Longest time taken to fill a buffer
+    uint32_t min_slack_us;  // Least time to spare after filling a buffer, UINT32_MAX if none
+};
+void i2s_out_get_stats(i2s_out_stats_t& stats);
+
 /*
    Reference: "ESP32 Technical Reference Manual" by Espressif Systems
      https://www.espressif.com/sites/default/files/documentation/esp32_technical_reference_manual_en.pdf
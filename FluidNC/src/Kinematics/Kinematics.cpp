@@ -18,6 +18,11 @@ namespace Kinematics {
         return _system->invalid_line(target);
     }
 
+    bool Kinematics::segments_lines() {
+        Assert(_system != nullptr, "No kinematic system");
+        return _system->segments_lines();
+    }
+
     bool Kinematics::invalid_arc(
         float* target, plan_line_data_t* pl_data, float* position, float center[3], float radius, size_t caxes[3], bool is_clockwise_arc) {
         Assert(_system != nullptr, "No kinematic system");
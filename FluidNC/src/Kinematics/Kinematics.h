@@ -42,6 +42,7 @@ namespace Kinematics {
 
         void constrain_jog(float* target, plan_line_data_t* pl_data, float* position);
         bool invalid_line(float* target);
+        bool segments_lines();
         bool invalid_arc(
             float* target, plan_line_data_t* pl_data, float* position, float center[3], float radius, size_t caxes[3], bool is_clockwise_arc);
 
@@ -72,6 +73,8 @@ namespace Kinematics {
 
         virtual void constrain_jog(float* cartesian, plan_line_data_t* pl_data, float* position) {}
         virtual bool invalid_line(float* cartesian) { return false; }
+        // True if cartesian_to_motors() splits a line into several planner lines
+        virtual bool segments_lines() { return false; }
         virtual bool invalid_arc(
             float* target, plan_line_data_t* pl_data, float* position, float center[3], float radius, size_t caxes[3], bool is_clockwise_arc) {
             return false;
@@ -41,6 +41,7 @@ namespace Kinematics {
         bool         kinematics_homing(AxisMask& axisMask) override;
         virtual void constrain_jog(float* cartesian, plan_line_data_t* pl_data, float* position) override;
         virtual bool invalid_line(float* cartesian) override;
+        bool         segments_lines() override { return true; }
         virtual bool invalid_arc(float*            target,
                                  plan_line_data_t* pl_data,
                                  float*            position,
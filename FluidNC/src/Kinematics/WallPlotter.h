@@ -27,6 +27,7 @@ namespace Kinematics {
         bool canHome(AxisMask axisMask) override;
         void init_position() override;
         bool cartesian_to_motors(float* target, plan_line_data_t* pl_data, float* position) override;
+        bool segments_lines() override { return true; }
         void motors_to_cartesian(float* cartesian, float* motors, int n_axis) override;
         bool transform_cartesian_to_motors(float* cartesian, float* motors) override;
         bool kinematics_homing(AxisMask& axisMask) override;
@@ -7,8 +7,31 @@
 #include "../Stepper.h"     // stepper_id_t
 #include "MachineConfig.h"  // config->
 #include "../Limits.h"
-
-const EnumItem axisType[] = { { 0, "X" }, { 1, "Y" }, { 2, "Z" }, { 3, "A" }, { 4, "B" }, { 5, "C" }, EnumItem(0) };
+#include "../Motors/TrinamicUartBus.h"
+#include "../Motors/TrinamicBase.h"  // TrinamicBase::start_sampler()
+#include "Driver/tmc_spi.h"  // tmc_spi_begin_batch()
+
+// Only the axes built in, see MAX_AXES in Config.h
+const EnumItem axisType[] = { { X_AXIS, "X" }, { Y_AXIS, "Y" }, { Z_AXIS, "Z" },
+#if MAX_AXES > 3
+                              { A_AXIS, "A" },
+#endif
+#if MAX_AXES > 4
+                              { B_AXIS, "B" },
+#endif
+#if MAX_AXES > 5
+                              { C_AXIS, "C" },
+#endif
+#if MAX_AXES > 6
+                              { U_AXIS, "U" },
+#endif
+#if MAX_AXES > 7
+                              { V_AXIS, "V" },
+#endif
+#if MAX_AXES > 8
+                              { W_AXIS, "W" },
+#endif
+                              EnumItem(X_AXIS) };
 
 namespace Machine {
     MotorMask Axes::posLimitMask = 0;
@@ -83,6 +106,8 @@ namespace Machine {
     MotorMask Axes::set_homing_mode(AxisMask axisMask, bool isHoming) {
         MotorMask motorsCanHome = 0;
 
+        // Drivers on a Trinamic SPI daisy chain share one transfer per register
+        tmc_spi_begin_batch();
         for (size_t axis = X_AXIS; axis < _numberAxis; axis++) {
             if (bitnum_is_true(axisMask, axis)) {
                 auto a = _axis[axis];
@@ -99,17 +124,19 @@ namespace Machine {
                 }
             }
         }
+        tmc_spi_end_batch();
+        MotorDrivers::TrinamicUartBus::sync_all();  // UART writes are queued
 
         return motorsCanHome;
     }
 
-    void IRAM_ATTR Axes::step(uint8_t step_mask, uint8_t dir_mask) {
+    // Set the direction pins, but optimize for the common
+    // situation where the direction bits haven't changed.
+    void IRAM_ATTR Axes::set_direction(AxisMask dir_mask) {
         auto n_axis = _numberAxis;
         //log_info("motors_set_direction_pins:0x%02X", onMask);
 
-        // Set the direction pins, but optimize for the common
-        // situation where the direction bits haven't changed.
-        static uint8_t previous_dir = 255;  // should never be this value
+        static AxisMask previous_dir = 0xffff;  // should never be this value
         if (dir_mask != previous_dir) {
             previous_dir = dir_mask;
 
@@ -125,6 +152,12 @@ namespace Machine {
             }
             config->_stepping->waitDirection();
         }
+    }
+
+    void IRAM_ATTR Axes::step(AxisMask step_mask, AxisMask dir_mask) {
+        auto n_axis = _numberAxis;
+
+        set_direction(dir_mask);
 
         // Turn on step pulses for motors that are supposed to step now
         for (size_t axis = X_AXIS; axis < n_axis; axis++) {
@@ -143,6 +176,41 @@ namespace Machine {
         config->_stepping->startPulseTimer();
     }
 
+    // Start the pulse trains for an RMT_burst or I2S_stream burst.  events[axis] lists
+    // the counts[axis] step events, period timer ticks apart, at which the
+    // axis steps.
+    void IRAM_ATTR Axes::step_burst(AxisMask dir_mask, const uint8_t (*events)[Stepping::maxBurstEvents], const uint8_t* counts, uint32_t period) {
+        auto n_axis = _numberAxis;
+
+        set_direction(dir_mask);
+
+        for (size_t axis = X_AXIS; axis < n_axis; axis++) {
+            if (counts[axis]) {
+                bool dir = bitnum_is_true(dir_mask, axis);
+
+                auto a = _axis[axis];
+                for (size_t motor = 0; motor < Axis::MAX_MOTORS_PER_AXIS; motor++) {
+                    auto m = a->_motors[motor];
+                    if (m) {
+                        m->step_burst(dir, events[axis], counts[axis], period);
+                    }
+                }
+            }
+        }
+    }
+
+    // Abandon the pulses of bursts that are still going out
+    void Axes::stop_bursts() {
+        for (size_t axis = X_AXIS; axis < _numberAxis; axis++) {
+            for (size_t motor = 0; motor < Axis::MAX_MOTORS_PER_AXIS; motor++) {
+                auto m = _axis[axis]->_motors[motor];
+                if (m) {
+                    m->_driver->stop_burst();
+                }
+            }
+        }
+    }
+
     // Turn all stepper pins off
     void IRAM_ATTR Axes::unstep() {
         config->_stepping->waitPulse();
@@ -159,10 +227,34 @@ namespace Machine {
         config->_stepping->finishPulse();
     }
 
+    // Called from the stepper ISR while homing
+    void IRAM_ATTR Axes::latch_limits() {
+        auto n_axis = _numberAxis;
+        for (size_t axis = X_AXIS; axis < n_axis; axis++) {
+            for (size_t motor = 0; motor < Axis::MAX_MOTORS_PER_AXIS; motor++) {
+                auto m = _axis[axis]->_motors[motor];
+                if (m) {
+                    m->latch_limits();
+                }
+            }
+        }
+    }
+
     void Axes::config_motors() {
+        tmc_spi_forget_registers();
+        tmc_spi_begin_batch();
         for (int axis = 0; axis < _numberAxis; ++axis) {
             _axis[axis]->config_motors();
+            for (size_t motor = 0; motor < Axis::MAX_MOTORS_PER_AXIS; motor++) {
+                auto m = _axis[axis]->_motors[motor];
+                if (m && !m->_driver->paces_bursts()) {
+                    _paced_bursts = false;
+                }
+            }
         }
+        tmc_spi_end_batch();
+        MotorDrivers::TrinamicUartBus::sync_all();
+        MotorDrivers::TrinamicBase::start_sampler();
     }
 
     // Some small helpers to find the axis index and axis motor index for a given motor. This
@@ -202,8 +294,9 @@ namespace Machine {
         handler.item("shared_stepper_disable_pin", _sharedStepperDisable);
         handler.item("shared_stepper_reset_pin", _sharedStepperReset);
         handler.item("homing_runs", _homing_runs, 1, 5);
+        handler.item("homing_independent", _homing_independent);
 
-        // Handle axis names xyzabc.  handler.section is inferred
+        // Handle axis names xyzabcuvw.  handler.section is inferred
         // from a template.
         char tmp[3];
         tmp[2] = '\0';
@@ -291,9 +384,10 @@ namespace Machine {
         for (int i = 0; i < lenNames; i++) {
             char  axisName = toupper(names[i]);
             char* pos      = index(_names, axisName);
-            if (!pos) {
+            if (!pos || pos - _names >= MAX_N_AXIS) {
                 log_error("Invalid axis name " << names[i]);
                 retval = false;
+                continue;
             }
             set_bitnum(mask, pos - Machine::Axes::_names);
         }
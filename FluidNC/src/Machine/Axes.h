@@ -6,6 +6,7 @@
 
 #include "../Configuration/Configurable.h"
 #include "Axis.h"
+#include "../Stepping.h"
 #include "../EnumItem.h"
 
 namespace MotorDrivers {
@@ -16,8 +17,10 @@ namespace Machine {
     class Axes : public Configuration::Configurable {
         bool _switchedStepper = false;
 
+        void set_direction(AxisMask dir_mask);
+
     public:
-        static constexpr const char* _names = "XYZABC";
+        static constexpr const char* _names = "XYZABCUVW";  // The first MAX_N_AXIS are in use
 
         Axes();
 
@@ -34,7 +37,8 @@ namespace Machine {
         Pin _sharedStepperDisable;
         Pin _sharedStepperReset;
 
-        uint32_t _homing_runs = 2;  // Number of Approach/Pulloff cycles
+        uint32_t _homing_runs        = 2;      // Number of Approach/Pulloff cycles
+        bool     _homing_independent = false;  // Each axis in a cycle runs its own phases
 
         inline char axisName(int index) { return index < MAX_N_AXIS ? _names[index] : '?'; }  // returns axis letter
 
@@ -45,6 +49,8 @@ namespace Machine {
         int   _numberAxis = 0;
         Axis* _axis[MAX_N_AXIS];
 
+        bool _paced_bursts = true;  // Every motor's driver paces_bursts()
+
         // Some small helpers to find the axis index and axis motor number for a given motor. This
         // is helpful for some motors that need this info, as well as debug information.
         size_t findAxisIndex(const MotorDrivers::MotorDriver* const motor) const;
@@ -74,8 +80,11 @@ namespace Machine {
 
         void set_disable(int axis, bool disable);
         void set_disable(bool disable);
-        void step(uint8_t step_mask, uint8_t dir_mask);
+        void step(AxisMask step_mask, AxisMask dir_mask);
+        void step_burst(AxisMask dir_mask, const uint8_t (*events)[Stepping::maxBurstEvents], const uint8_t* counts, uint32_t period);
+        void stop_bursts();
         void unstep();
+        void latch_limits();
         void config_motors();
 
         std::string maskToNames(AxisMask mask);
@@ -8,6 +8,7 @@
 #include "../Machine/MachineConfig.h"  // config
 
 #include <cmath>
+#include <freertos/task.h>  // xTaskGetTickCount
 
 namespace Machine {
     // Calculate the motion for the next homing move.
@@ -32,6 +33,8 @@ namespace Machine {
     const uint32_t MOTOR0 = 0xffff;
     const uint32_t MOTOR1 = 0xffff0000;
 
+    const uint32_t min_move_ms = 20;  // Independent homing waits instead for a settling axis that is this close to ready
+
     Homing::Phase   Homing::_phase       = Phase::None;
     AxisMask        Homing::_cycleAxes   = 0;
     AxisMask        Homing::_phaseAxes   = 0;
@@ -42,6 +45,12 @@ namespace Machine {
 
     uint32_t Homing::_runs;
 
+    bool              Homing::_independent  = false;
+    AxisMask          Homing::_approachAxes = 0;
+    AxisMask          Homing::_moveAxes     = 0;
+    Homing::AxisRun   Homing::_axisRuns[MAX_N_AXIS];
+    float             Homing::_moveStart[MAX_N_AXIS];
+
     AxisMask Homing::_unhomed_axes;  // Bitmap of axes whose position is unknown
 
     bool Homing::axis_is_homed(size_t axis) {
@@ -72,7 +81,10 @@ namespace Machine {
         float rate;
         float target[config->_axes->_numberAxis];
         axisVector(_phaseAxes, _phaseMotors, _phase, target, rate, _settling_ms);
+        moveTo(target, rate);
+    }
 
+    void Homing::moveTo(float* target, float rate) {
         plan_line_data_t plan_data      = {};
         plan_data.spindle_speed         = 0;
         plan_data.motion                = {};
@@ -95,6 +107,10 @@ namespace Machine {
     }
 
     void Homing::cycleStop() {
+        if (_independent) {
+            independentCycleStop();
+            return;
+        }
         log_debug("CycleStop " << phaseName(_phase));
         if (approach()) {
             // Cycle stop while approaching means that we did not hit
@@ -311,6 +327,11 @@ namespace Machine {
     void Homing::limitReached() {
         // As limit bits are set, let the kinematics system figure out what that
         // means in terms of axes, motors, and whether to stop and replan
+        if (_independent) {
+            independentLimitReached();
+            return;
+        }
+
         MotorMask limited = Machine::Axes::posLimitMask | Machine::Axes::negLimitMask;
 
         if (!approach()) {
@@ -345,6 +366,272 @@ namespace Machine {
         }
     }
 
+    // Independent homing.  The axes of the cycle share each move, as in
+    // axisVector(), but each one is in its own phase and moves at the
+    // rate for that phase.  A move lasts until the first axis finishes
+    // its phase or a settling axis is ready to start its next one, so that
+    // every axis in the move keeps its own rate.  An axis whose switch
+    // trips stops at once, which cuts the move short for the others; the
+    // move is then replanned from where they are.
+
+    void Homing::startIndependent() {
+        auto n_axis = config->_axes->_numberAxis;
+
+        _approachAxes = 0;
+        _moveAxes     = 0;
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            if (bitnum_is_false(_cycleAxes, axis)) {
+                continue;
+            }
+            auto& run    = _axisRuns[axis];
+            run          = {};
+            run.runs     = config->_axes->_homing_runs;
+            run.phase    = PrePulloff;
+            MotorMask mm = _cycleMotors & Machine::Axes::axes_to_motors(bitnum_to_mask(axis));
+            if (!mm) {
+                // set_homing_mode() rejected the motors or handles them itself
+                run.phase = CycleDone;
+                continue;
+            }
+            startAxisPhase(axis);
+            if (state_is(State::Alarm)) {
+                return;
+            }
+        }
+        independentMove();
+    }
+
+    // Set up the distance and rate for the axis's phase, skipping
+    // phases that have nothing to do.
+    void Homing::startAxisPhase(size_t axis) {
+        auto  axisConfig = config->_axes->_axis[axis];
+        auto  homing     = axisConfig->_homing;
+        auto& run        = _axisRuns[axis];
+
+        AxisMask  axisMask   = bitnum_to_mask(axis);
+        MotorMask axisMotors = _cycleMotors & Machine::Axes::axes_to_motors(axisMask);
+
+        while (true) {
+            float toward = homing->_positiveDirection ? 1.0f : -1.0f;
+
+            run.rate = homing->_feedRate;
+            switch (run.phase) {
+                case PrePulloff: {
+                    bool posLimited = bits_are_true(Machine::Axes::posLimitMask, axisMotors);
+                    bool negLimited = bits_are_true(Machine::Axes::negLimitMask, axisMotors);
+                    if (posLimited && negLimited) {
+                        log_error("Both positive and negative limit switches are active for axis " << config->_axes->axisName(axis));
+                        fail(ExecAlarm::HomingAmbiguousSwitch);
+                        return;
+                    }
+                    run.remaining = posLimited ? -axisConfig->commonPulloff() : negLimited ? axisConfig->commonPulloff() : 0;
+                } break;
+                case FastApproach:
+                    run.rate      = homing->_seekRate;
+                    run.remaining = toward * axisConfig->_maxTravel * homing->_seek_scaler;
+                    break;
+                case SlowApproach:
+                    run.remaining = toward * axisConfig->commonPulloff() * homing->_feed_scaler;
+                    break;
+                case Pulloff0:
+                case Pulloff1:
+                    run.remaining = -toward * axisConfig->commonPulloff();
+                    break;
+                case Pulloff2: {
+                    float travel = axisConfig->extraPulloff();
+                    if (travel < 0) {
+                        // Motor0's pulloff is greater than motor1's, so we block motor1
+                        axisConfig->_motors[1]->block();
+                        travel = -travel;
+                    } else if (travel > 0) {
+                        // Motor1's pulloff is greater than motor0's, so we block motor0
+                        axisConfig->_motors[0]->block();
+                    }
+                    // All motors will be unblocked later by set_homing_mode()
+                    run.remaining = -toward * travel;
+                } break;
+                default:
+                    run.remaining = 0;
+                    break;
+            }
+            if (run.phase == CycleDone || run.remaining != 0) {
+                break;
+            }
+            nextAxisPhase(axis);
+        }
+
+        if (run.phase == FastApproach || run.phase == SlowApproach) {
+            set_bits(_approachAxes, axisMask);
+        } else {
+            clear_bits(_approachAxes, axisMask);
+        }
+        if (run.phase != CycleDone) {
+            config->_kinematics->releaseMotors(axisMask, axisMotors);
+        }
+        log_debug("Homing " << config->_axes->axisName(axis) << " " << phaseName(run.phase));
+    }
+
+    // The per-axis form of nextPhase()
+    void Homing::nextAxisPhase(size_t axis) {
+        auto& run = _axisRuns[axis];
+
+        run.phase = static_cast<Phase>(static_cast<int>(run.phase) + 1);
+        if (run.phase == SlowApproach && run.runs == 1) {
+            run.phase = Pulloff2;
+        } else if (run.phase == Pulloff2 && --run.runs > 1) {
+            run.phase = SlowApproach;
+        }
+        if (run.phase == Pulloff2 && !needsPulloff2(_cycleMotors & Machine::Axes::axes_to_motors(bitnum_to_mask(axis)))) {
+            run.phase = CycleDone;
+        }
+    }
+
+    // The axis has finished the motion for its phase; it settles before
+    // it starts the next one.
+    void Homing::endAxisPhase(size_t axis) {
+        auto& run = _axisRuns[axis];
+
+        clear_bitnum(_approachAxes, axis);
+        clear_bitnum(_moveAxes, axis);
+        run.remaining  = 0;
+        run.settling   = true;
+        run.settle_end = xTaskGetTickCount() + config->_axes->_axis[axis]->_homing->_settle_ms / portTICK_PERIOD_MS;
+    }
+
+    void Homing::independentMove() {
+        auto n_axis = config->_axes->_numberAxis;
+
+        while (true) {
+            TickType_t now      = xTaskGetTickCount();
+            TickType_t wait     = portMAX_DELAY;  // Until the next settling axis is ready
+            float      minutes  = INFINITY;       // Until the first moving axis finishes
+            bool       settling = false;
+            bool       moving   = false;
+
+            for (size_t axis = 0; axis < n_axis; axis++) {
+                if (bitnum_is_false(_cycleAxes, axis)) {
+                    continue;
+                }
+                auto& run = _axisRuns[axis];
+                if (run.settling) {
+                    if (int32_t(now - run.settle_end) < 0) {
+                        settling = true;
+                        wait     = std::min(wait, run.settle_end - now);
+                        continue;
+                    }
+                    run.settling = false;
+                    nextAxisPhase(axis);
+                    startAxisPhase(axis);
+                    if (state_is(State::Alarm)) {
+                        return;
+                    }
+                }
+                if (run.phase == CycleDone) {
+                    continue;
+                }
+                moving  = true;
+                minutes = std::min(minutes, fabsf(run.remaining) / run.rate);
+            }
+
+            if (!moving && !settling) {
+                set_mpos();
+                nextCycle();
+                return;
+            }
+            if (!moving || (settling && wait * portTICK_PERIOD_MS < min_move_ms)) {
+                // Nothing worth moving before the next axis is ready
+                delay_ms(wait * portTICK_PERIOD_MS);
+                continue;
+            }
+            if (settling) {
+                minutes = std::min(minutes, wait * portTICK_PERIOD_MS / 60000.0f);
+            }
+
+            float* mpos = get_mpos();
+            copyAxes(_moveStart, mpos);
+
+            float target[n_axis];
+            copyAxes(target, mpos);
+
+            float ratesq = 0;
+            _moveAxes    = 0;
+            for (size_t axis = 0; axis < n_axis; axis++) {
+                auto& run = _axisRuns[axis];
+                if (bitnum_is_false(_cycleAxes, axis) || run.settling || run.phase == CycleDone) {
+                    continue;
+                }
+                float distance = std::min(fabsf(run.remaining), run.rate * minutes);
+                run.planned    = run.remaining < 0 ? -distance : distance;
+                target[axis] += run.planned;
+                ratesq += run.rate * run.rate;
+                set_bitnum(_moveAxes, axis);
+            }
+            log_debug("Homing move " << config->_axes->maskToNames(_moveAxes));
+
+            moveTo(target, sqrtf(ratesq));
+            return;
+        }
+    }
+
+    // The move is complete, so every axis in it has gone the planned distance
+    void Homing::independentCycleStop() {
+        auto n_axis = config->_axes->_numberAxis;
+
+        Stepper::reset();
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            if (bitnum_is_false(_moveAxes, axis)) {
+                continue;
+            }
+            auto& run = _axisRuns[axis];
+            run.remaining -= run.planned;
+            if (fabsf(run.remaining) > fabsf(run.planned) * 1e-4f) {
+                continue;
+            }
+            if (run.phase == FastApproach || run.phase == SlowApproach) {
+                // The switch did not trip in the programmed distance
+                fail(ExecAlarm::HomingFailApproach);
+                report_realtime_status(allChannels);
+                return;
+            }
+            if (limited() & _cycleMotors & Machine::Axes::axes_to_motors(bitnum_to_mask(axis))) {
+                fail(ExecAlarm::HomingFailPulloff);
+                return;
+            }
+            endAxisPhase(axis);
+        }
+        independentMove();
+    }
+
+    void Homing::independentLimitReached() {
+        AxisMask  axes   = _approachAxes;
+        MotorMask motors = _cycleMotors & Machine::Axes::axes_to_motors(_approachAxes);
+
+        // Switches on axes that are pulling off are chatter
+        if (!config->_kinematics->limitReached(axes, motors, limited() & motors)) {
+            return;
+        }
+
+        // An axis is at its switch.  Stop, and account for how far the
+        // others got before replanning.
+        Stepper::reset();
+
+        float* mpos   = get_mpos();
+        auto   n_axis = config->_axes->_numberAxis;
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            if (bitnum_is_false(_moveAxes, axis)) {
+                continue;
+            }
+            auto& run = _axisRuns[axis];
+            if (bitnum_is_true(_approachAxes, axis) && bitnum_is_false(axes, axis)) {
+                log_debug("Homing " << config->_axes->axisName(axis) << " limited");
+                endAxisPhase(axis);
+            } else {
+                run.remaining -= mpos[axis] - _moveStart[axis];
+            }
+        }
+        independentMove();
+    }
+
     void Homing::done() {
         log_debug("Homing done");
 
@@ -385,13 +672,19 @@ namespace Machine {
         _cycleAxes &= Machine::Axes::homingMask;
         _cycleMotors = config->_axes->set_homing_mode(_cycleAxes, true);
 
-        _phase = Phase::PrePulloff;
-        _runs  = config->_axes->_homing_runs;
-        runPhase();
+        _phase       = Phase::PrePulloff;
+        _runs        = config->_axes->_homing_runs;
+        _independent = config->_axes->_homing_independent;
+        if (_independent) {
+            startIndependent();
+        } else {
+            runPhase();
+        }
     }
 
     void Homing::fail(ExecAlarm alarm) {
         Stepper::reset();  // Stop moving
+        _approachAxes = 0;
         send_alarm(alarm);
         config->_axes->set_homing_mode(_cycleAxes, false);  // tell motors homing is done...failed
         config->_axes->set_disable(config->_stepping->_idleMsecs != 255);
@@ -9,6 +9,8 @@
 #include "src/Protocol.h"  // ExecAlarm
 #include <queue>
 
+#include <freertos/FreeRTOS.h>  // TickType_t
+
 namespace Machine {
     class Homing : public Configuration::Configurable {
         static AxisMask _unhomed_axes;
@@ -41,6 +43,9 @@ namespace Machine {
 
         static bool approach() { return _phase == FastApproach || _phase == SlowApproach; }
 
+        // Whether limit switches on this axis should latch its motors
+        static bool approach(size_t axis) { return _independent ? bitnum_is_true(_approachAxes, axis) : approach(); }
+
         static void fail(ExecAlarm alarm);
         static void cycleStop();
 
@@ -92,6 +97,7 @@ namespace Machine {
 
     private:
         static uint32_t planMove(AxisMask axisMask, MotorMask motors, Phase phase, float* target, float& rate);
+        static void     moveTo(float* target, float rate);
 
         static void done();
         static void runPhase();
@@ -107,6 +113,35 @@ namespace Machine {
 
         static uint32_t _settling_ms;
 
+        // Independent homing (axes: homing_independent: true).  Each axis
+        // of the cycle steps through the phases on its own, at its own
+        // rates, and settles while the others keep moving.  Every switch
+        // trip and every completed move replans one move for all the axes
+        // that are not settling.
+        struct AxisRun {
+            Phase      phase;
+            uint32_t   runs;
+            float      remaining;  // mm still to go in this phase, signed
+            float      rate;       // mm/min in this phase
+            float      planned;    // mm of remaining in the current move
+            bool       settling;   // The phase is over; wait until settle_end
+            TickType_t settle_end;
+        };
+
+        static bool      _independent;   // This cycle homes its axes independently
+        static AxisMask  _approachAxes;  // Axes in an approach phase
+        static AxisMask  _moveAxes;      // Axes in the current move
+        static AxisRun   _axisRuns[MAX_N_AXIS];
+        static float     _moveStart[MAX_N_AXIS];
+
+        static void startIndependent();
+        static void startAxisPhase(size_t axis);
+        static void nextAxisPhase(size_t axis);
+        static void endAxisPhase(size_t axis);
+        static void independentMove();
+        static void independentCycleStop();
+        static void independentLimitReached();
+
         static const char* _phaseNames[];
         static const char* phaseName(Phase phase) { return _phaseNames[static_cast<int>(phase)]; }
     };
@@ -12,16 +12,29 @@ namespace Machine {
             Assert(_data.defined(), "I2SO Data pin should be configured once");
             Assert(_ws.defined(), "I2SO WS pin should be configured once");
         }
+        Assert(_sample_us >= I2S_OUT_MIN_USEC_PER_PULSE && _sample_us <= I2S_OUT_MAX_USEC_PER_PULSE,
+               "I2SO sample_us must be between %d and %d for the bus clock",
+               I2S_OUT_MIN_USEC_PER_PULSE,
+               I2S_OUT_MAX_USEC_PER_PULSE);
+        Assert(_dma_buffer_bytes % 4 == 0, "I2SO dma_buffer_bytes must be a multiple of 4");
+        uint32_t buffer_us = _dma_buffer_bytes / 4 * _sample_us;
+        if (buffer_us < 1000) {
+            log_warn("I2SO DMA buffers last " << buffer_us << " us, less than the 1 ms task tick; expect underruns");
+        }
     }
 
     void I2SOBus::group(Configuration::HandlerBase& handler) {
         handler.item("bck_pin", _bck);
         handler.item("data_pin", _data);
         handler.item("ws_pin", _ws);
+        handler.item("sample_us", _sample_us, 1, 255);
+        handler.item("dma_buffer_bytes", _dma_buffer_bytes, 256, I2S_OUT_DMABUF_MAX_LEN);
+        handler.item("dma_buffer_count", _dma_buffer_count, 2, 32);
     }
 
     void I2SOBus::init() {
-        log_info("I2SO BCK:" << _bck.name() << " WS:" << _ws.name() << " DATA:" << _data.name());
+        log_info("I2SO BCK:" << _bck.name() << " WS:" << _ws.name() << " DATA:" << _data.name() << " Sample:" << _sample_us
+                              << "us Buffers:" << _dma_buffer_count << "x" << _dma_buffer_bytes);
         i2s_out_init();
     }
 }
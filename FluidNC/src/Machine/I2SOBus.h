@@ -15,6 +15,13 @@ namespace Machine {
         Pin _data;
         Pin _ws;
 
+        // Stream timing: one sample every _sample_us, in _dma_buffer_count
+        // buffers of _dma_buffer_bytes.  The buffers together set the output
+        // latency; shorter ones must be refilled more often.
+        uint32_t _sample_us        = 4;
+        uint32_t _dma_buffer_bytes = 2000;
+        uint32_t _dma_buffer_count = 5;
+
         void validate() override;
         void group(Configuration::HandlerBase& handler) override;
 
@@ -51,11 +51,22 @@ namespace Machine {
         _pin->setAttr(Pin::Attr::Input);
         _pin->registerEvent(static_cast<EventPin*>(this));
         update(get());
+        _fast = _pin->capabilities().has(Pin::Capabilities::ISR);
+    }
+
+    void IRAM_ATTR LimitPin::latch() {
+        if (_fast && Homing::approach(_axis) && _pin->read()) {
+            _pLimited = true;
+
+            if (_pExtraLimited != nullptr) {
+                *_pExtraLimited = true;
+            }
+        }
     }
 
     void LimitPin::update(bool value) {
         if (value) {
-            if (Homing::approach() || (!state_is(State::Homing) && _pHardLimits)) {
+            if (Homing::approach(_axis) || (!state_is(State::Homing) && _pHardLimits)) {
                 _pLimited = value;
 
                 if (_pExtraLimited != nullptr) {
@@ -26,12 +26,19 @@ namespace Machine {
         volatile uint32_t* _negLimits = nullptr;
 
         Pin* _pin;
+        bool _fast = false;  // The stepper ISR can read _pin
 
     public:
         LimitPin(Pin& pin, int axis, int motorNum, int direction, bool& phardLimits, bool& pLimited);
 
         void update(bool value) override;
 
+        // Called from the stepper ISR while homing.  Reads the pin and
+        // stops the motor at the step where the switch closes, instead of
+        // when the pin is next polled.  The polled event still follows
+        // and sets the limit masks for Homing::limitReached().
+        void latch();
+
         void init();
         void makeDualMask();  // makes this a mask for motor0 and motor1
         void setExtraMotorLimit(int axis, int motorNum);
@@ -62,6 +62,7 @@ namespace Machine {
         handler.section("control", _control);
         handler.section("coolant", _coolant);
         handler.section("probe", _probe);
+        handler.section("spindle_encoder", _spindle_encoder);
         handler.section("macros", _macros);
         handler.section("start", _start);
         handler.section("parking", _parking);
@@ -100,6 +101,10 @@ namespace Machine {
             _probe = new Probe();
         }
 
+        if (_spindle_encoder == nullptr) {
+            _spindle_encoder = new SpindleEncoder();
+        }
+
         if (_userOutputs == nullptr) {
             _userOutputs = new UserOutputs();
         }
@@ -253,6 +258,7 @@ namespace Machine {
         delete _i2so;
         delete _coolant;
         delete _probe;
+        delete _spindle_encoder;
         delete _sdCard;
         delete _spi;
         delete _control;
@@ -80,12 +80,30 @@ namespace Machine {
         }
         _driver->step();
         _steps += reverse ? -1 : 1;
+        _pulses += reverse ? -1 : 1;
+    }
+
+    void IRAM_ATTR Motor::step_burst(bool reverse, const uint8_t* events, size_t count, uint32_t period) {
+        if (_blocked || _limited) {
+            return;
+        }
+        _driver->step_burst(events, count, period);
+        _steps += reverse ? -int32_t(count) : int32_t(count);
+        _pulses += reverse ? -int32_t(count) : int32_t(count);
     }
 
     void IRAM_ATTR Motor::unstep() {
         _driver->unstep();
     }
 
+    void IRAM_ATTR Motor::latch_limits() {
+        if (!_limited) {
+            _negLimitPin->latch();
+            _posLimitPin->latch();
+            _allLimitPin->latch();
+        }
+    }
+
     Motor::~Motor() {
         delete _driver;
     }
@@ -36,6 +36,7 @@ namespace Machine {
         bool _hardLimits = false;
 
         int32_t _steps   = 0;
+        int32_t _pulses  = 0;      // Step pulses sent.  Unlike _steps, never set, so the driver can count them too
         bool    _limited = false;  // _limited is set by the LimitPin ISR
         bool    _blocked = false;  // _blocked is used during asymmetric homing pulloff
 
@@ -49,7 +50,9 @@ namespace Machine {
         void init();
         void config_motor();
         void step(bool reverse);
+        void step_burst(bool reverse, const uint8_t* events, size_t count, uint32_t period);
         void unstep();
+        void latch_limits();
         void block() { _blocked = true; }
         void unblock() { _blocked = false; }
         void unlimit() { _limited = false; }
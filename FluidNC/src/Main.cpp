@@ -124,6 +124,7 @@ void setup() {
 
             config->_coolant->init();
             config->_probe->init();
+            config->_spindle_encoder->init();
         }
 
     } catch (const AssertionFailed& ex) {
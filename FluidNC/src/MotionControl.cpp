@@ -14,8 +14,11 @@
 #include "I2SOut.h"          // i2s_out_reset
 #include "Platform.h"        // WEAK_LINK
 #include "Settings.h"        // coords
+#include "SpindleSync.h"     // SpindleSync::start
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 // M_PI is not defined in standard C/C++ but some compilers
 // support it anyway.  The following suppresses Intellisense
@@ -278,9 +281,35 @@ volatile bool probing;
 
 bool probe_succeeded = false;
 
+// Set the current work coordinate offset of the probed axis so that the
+// probe position, probe_steps, is at offset.
+static void probe_apply_offset(uint8_t offsetAxis, float offset) {
+    if (offset == __FLT_MAX__) {
+        return;
+    }
+    float coord_data[MAX_N_AXIS];
+    float probe_contact[MAX_N_AXIS];
+
+    motor_steps_to_mpos(probe_contact, probe_steps);
+    coords[gc_state.modal.coord_select]->get(coord_data);  // get a copy of the current coordinate offsets
+    auto n_axis = config->_axes->_numberAxis;
+    for (int axis = 0; axis < n_axis; axis++) {  // find the axis specified. There should only be one.
+        if (offsetAxis & (1 << axis)) {
+            coord_data[axis] = probe_contact[axis] - offset;
+            break;
+        }
+    }
+    log_info("Probe offset applied:");
+    coords[gc_state.modal.coord_select]->set(coord_data);  // save it
+    copyAxes(gc_state.coord_system, coord_data);
+    report_wco_counter = 0;
+}
+
 // Perform tool length probe cycle. Requires probe switch.
 // NOTE: Upon probe failure, the program will be stopped and placed into ALARM state.
-GCUpdatePos mc_probe_cycle(float* target, plan_line_data_t* pl_data, bool away, bool no_error, uint8_t offsetAxis, float offset) {
+// report=false skips the [PRB:] message, for callers that probe many points.
+GCUpdatePos mc_probe_cycle(
+    float* target, plan_line_data_t* pl_data, bool away, bool no_error, uint8_t offsetAxis, float offset, bool report) {
     if (!config->_probe->exists()) {
         log_error("Probe pin is not configured");
         return GCUpdatePos::None;
@@ -341,7 +370,7 @@ GCUpdatePos mc_probe_cycle(float* target, plan_line_data_t* pl_data, bool away,
     Stepper::reset();      // Reset step segment buffer.
     plan_reset();          // Reset planner buffer. Zero planner positions. Ensure probing motion is cleared.
     plan_sync_position();  // Sync planner position to current machine position.
-    if (MESSAGE_PROBE_COORDINATES) {
+    if (MESSAGE_PROBE_COORDINATES && report) {
         // All done! Output the probe position as message.
         report_probe_parameters(allChannels);
     }
@@ -349,31 +378,191 @@ GCUpdatePos mc_probe_cycle(float* target, plan_line_data_t* pl_data, bool away,
     //     config->_tool_changer->probe_notification();
     // }
     if (probe_succeeded) {
-        if (offset != __FLT_MAX__) {
-            float coord_data[MAX_N_AXIS];
-            float probe_contact[MAX_N_AXIS];
-
-            motor_steps_to_mpos(probe_contact, probe_steps);
-            coords[gc_state.modal.coord_select]->get(coord_data);  // get a copy of the current coordinate offsets
-            auto n_axis = config->_axes->_numberAxis;
-            for (int axis = 0; axis < n_axis; axis++) {  // find the axis specified. There should only be one.
-                if (offsetAxis & (1 << axis)) {
-                    coord_data[axis] = probe_contact[axis] - offset;
-                    break;
-                }
-            }
-            log_info("Probe offset applied:");
-            coords[gc_state.modal.coord_select]->set(coord_data);  // save it
-            copyAxes(gc_state.coord_system, coord_data);
-            report_wco_counter = 0;
-        }
-
+        probe_apply_offset(offsetAxis, offset);
         return GCUpdatePos::System;  // Successful probe cycle.
     } else {
         return GCUpdatePos::Target;  // Failed to trigger probe within travel. With or without error.
     }
 }
 
+// Move back along the probe direction, away from the contact
+static bool probe_retract(const float* back, float distance, float feed) {
+    gc_sync_position();
+
+    float target[MAX_N_AXIS];
+    auto  n_axis = config->_axes->_numberAxis;
+    for (int axis = 0; axis < n_axis; axis++) {
+        target[axis] = gc_state.position[axis] + back[axis] * distance;
+    }
+
+    plan_line_data_t plan_data      = {};
+    plan_data.motion.noFeedOverride = 1;
+    plan_data.spindle               = SpindleState::Disable;
+    plan_data.feed_rate             = feed;
+    plan_data.line_number           = gc_state.line_number;
+
+    mc_linear(target, &plan_data, gc_state.position);
+    protocol_buffer_synchronize();
+    copyAxes(gc_state.position, target);
+    return !sys.abort;
+}
+
+// Perform a multi-touch probe cycle.  The first touch, at the programmed
+// feed, finds the surface.  Then come touches more at touch_feed, each
+// starting retract back from the last contact.  Touches whose position
+// is more than three median absolute deviations from the median, in
+// any axis, are dropped and the rest are averaged into probe_steps, so
+// the result is in #5061+ as for a single touch.  The cycle ends with a
+// final retract so the probe is clear.
+GCUpdatePos mc_probe_multi(float*            target,
+                           plan_line_data_t* pl_data,
+                           bool              no_error,
+                           uint8_t           offsetAxis,
+                           float             offset,
+                           uint8_t           touches,
+                           float             touch_feed,
+                           float             retract) {
+    if (state_is(State::CheckMode)) {
+        return mc_probe_cycle(target, pl_data, false, no_error, offsetAxis, offset);
+    }
+
+    auto  n_axis = config->_axes->_numberAxis;
+    float goal[MAX_N_AXIS];
+    float back[MAX_N_AXIS];  // Unit vector from the target back to the start
+    float length = 0;
+    for (int axis = 0; axis < n_axis; axis++) {
+        goal[axis] = target[axis];
+        back[axis] = gc_state.position[axis] - target[axis];
+        length += back[axis] * back[axis];
+    }
+    length = sqrtf(length);
+    for (int axis = 0; axis < n_axis; axis++) {
+        back[axis] /= length;
+    }
+
+    float       fast_feed = pl_data->feed_rate;
+    GCUpdatePos result    = mc_probe_cycle(target, pl_data, false, no_error, 0, __FLT_MAX__);
+    if (!probe_succeeded) {
+        return result;
+    }
+
+    std::vector<int32_t> steps(touches * n_axis);
+    pl_data->feed_rate = touch_feed;
+    for (int touch = 0; touch < touches; touch++) {
+        if (!probe_retract(back, retract, fast_feed)) {
+            return GCUpdatePos::None;
+        }
+        copyAxes(target, goal);
+        result = mc_probe_cycle(target, pl_data, false, no_error, 0, __FLT_MAX__);
+        if (!probe_succeeded) {
+            return result;
+        }
+        std::copy(probe_steps, probe_steps + n_axis, &steps[touch * n_axis]);
+    }
+
+    std::vector<bool>    keep(touches, true);
+    std::vector<int32_t> values(touches);
+    float                spread = 0;  // mm, largest deviation from the median
+    for (int axis = 0; axis < n_axis; axis++) {
+        for (int touch = 0; touch < touches; touch++) {
+            values[touch] = steps[touch * n_axis + axis];
+        }
+        std::nth_element(values.begin(), values.begin() + touches / 2, values.end());
+        int32_t median = values[touches / 2];
+
+        for (int touch = 0; touch < touches; touch++) {
+            values[touch] = std::abs(steps[touch * n_axis + axis] - median);
+        }
+        std::nth_element(values.begin(), values.begin() + touches / 2, values.end());
+        int32_t limit = std::max(3 * values[touches / 2], int32_t(1));  // A step either way is resolution, not an outlier
+
+        for (int touch = 0; touch < touches; touch++) {
+            int32_t deviation = std::abs(steps[touch * n_axis + axis] - median);
+            spread            = std::max(spread, steps_to_mpos(deviation, axis));
+            if (deviation > limit) {
+                keep[touch] = false;
+            }
+        }
+    }
+
+    int kept = std::count(keep.begin(), keep.end(), true);
+    if (!kept) {
+        // Outliers in different axes; nothing agrees, so use them all
+        keep.assign(touches, true);
+        kept = touches;
+    }
+    for (int axis = 0; axis < n_axis; axis++) {
+        int64_t sum = 0;
+        for (int touch = 0; touch < touches; touch++) {
+            if (keep[touch]) {
+                sum += steps[touch * n_axis + axis];
+            }
+        }
+        probe_steps[axis] = int32_t(lroundf(float(sum) / kept));
+    }
+    log_info("Probe touches used:" << kept << " of " << int(touches) << " spread:" << spread << "mm");
+
+    if (!probe_retract(back, retract, fast_feed)) {
+        return GCUpdatePos::None;
+    }
+    if (MESSAGE_PROBE_COORDINATES) {
+        report_probe_parameters(allChannels);
+    }
+    probe_apply_offset(offsetAxis, offset);
+    return GCUpdatePos::System;
+}
+
+// Perform a spindle-synchronized move (G33) or rigid tapping cycle (G33.1). Requires a spindle encoder.
+GCUpdatePos mc_spindle_sync(float* target, plan_line_data_t* pl_data, float* position, float mm_per_rev, bool rigid_tap) {
+    if (state_is(State::CheckMode)) {
+        return GCUpdatePos::Target;
+    }
+    // The move must start from rest, at a known spindle angle, so finish everything queued first.
+    protocol_buffer_synchronize();
+    if (sys.abort) {
+        return GCUpdatePos::None;
+    }
+
+    SpindleState direction = pl_data->spindle;
+    int          sign      = direction == SpindleState::Ccw ? -1 : 1;
+    float        start[MAX_N_AXIS];
+    copyAxes(start, position);
+
+    pl_data->feed_rate             = mm_per_rev * pl_data->spindle_speed;  // Nominal, for the planner
+    pl_data->motion.inverseTime    = 0;
+    pl_data->motion.noFeedOverride = 1;
+    pl_data->motion.spindleSync    = 1;
+
+    if (!SpindleSync::start(mm_per_rev, sign, true)) {
+        send_alarm(ExecAlarm::SpindleControl);
+        return GCUpdatePos::None;
+    }
+    mc_linear(target, pl_data, start);
+    protocol_buffer_synchronize();
+    SpindleSync::stop();
+    if (sys.abort || !rigid_tap) {
+        return GCUpdatePos::Target;
+    }
+
+    // Reverse the spindle and follow it back out.  The sync restarts from the
+    // spindle angle at the bottom of the hole, so the tap retraces the thread
+    // once the spindle has taken up its overrun.
+    SpindleState reverse = direction == SpindleState::Ccw ? SpindleState::Cw : SpindleState::Ccw;
+    if (!SpindleSync::start(mm_per_rev, -sign, false)) {
+        send_alarm(ExecAlarm::SpindleControl);
+        return GCUpdatePos::None;
+    }
+    spindle->setState(reverse, pl_data->spindle_speed);
+    pl_data->spindle = reverse;
+    mc_linear(start, pl_data, target);
+    protocol_buffer_synchronize();
+    SpindleSync::stop();
+
+    spindle->setState(direction, pl_data->spindle_speed);
+    copyAxes(target, start);
+    return GCUpdatePos::Target;
+}
+
 void mc_override_ctrl_update(Override override_state) {
     // Finish all queued commands before altering override control state
     protocol_buffer_synchronize();
@@ -44,7 +44,22 @@ void mc_arc(float*            target,
 bool mc_dwell(int32_t milliseconds);
 
 // Perform tool length probe cycle. Requires probe switch.
-GCUpdatePos mc_probe_cycle(float* target, plan_line_data_t* pl_data, bool away, bool no_error, uint8_t offsetAxis, float offset);
+GCUpdatePos mc_probe_cycle(
+    float* target, plan_line_data_t* pl_data, bool away, bool no_error, uint8_t offsetAxis, float offset, bool report = true);
+
+// Multi-touch probe cycle, G38.2/G38.3 with L touches at feed Q, each from R back.
+GCUpdatePos mc_probe_multi(float*            target,
+                           plan_line_data_t* pl_data,
+                           bool              no_error,
+                           uint8_t           offsetAxis,
+                           float             offset,
+                           uint8_t           touches,
+                           float             touch_feed,
+                           float             retract);
+
+// Perform a spindle-synchronized move (G33), or a rigid tapping cycle (G33.1) that also
+// reverses the spindle and retracts to the start position. Requires a spindle encoder.
+GCUpdatePos mc_spindle_sync(float* target, plan_line_data_t* pl_data, float* position, float mm_per_rev, bool rigid_tap);
 
 // Handles updating the override control state.
 void mc_override_ctrl_update(Override override_state);
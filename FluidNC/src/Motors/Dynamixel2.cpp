@@ -11,6 +11,12 @@
 
     https://emanual.robotis.com/docs/en/dxl/protocol2/
 
+    Each update sends the position the axes will reach lead_ms from now,
+    taken from the stepper segment queue, so the servos do not trail the
+    stepper axes by the update period.  With profile_velocity, the
+    profile velocity is sent along with the goal so that the servo moves
+    there at the planned speed rather than as fast as it can.
+
 */
 
 #include "Dynamixel2.h"
@@ -19,6 +25,7 @@
 #include "../System.h"   // mpos_to_steps() etc
 #include "../Limits.h"   // limitsMinPosition
 #include "../Planner.h"  // plan_sync_position()
+#include "../Stepper.h"  // predict_motor_steps()
 
 #include <cstdarg>
 #include <cmath>
@@ -29,7 +36,9 @@ namespace MotorDrivers {
     std::vector<Dynamixel2*> Dynamixel2::_instances;
     bool                     Dynamixel2::_has_errors = false;
 
-    int Dynamixel2::_timer_ms = 75;
+    int  Dynamixel2::_timer_ms         = 75;
+    int  Dynamixel2::_lead_ms          = -1;
+    bool Dynamixel2::_profile_velocity = false;
 
     uint8_t Dynamixel2::_tx_message[100];  // send to dynamixel
     uint8_t Dynamixel2::_rx_message[50];   // received from dynamixel
@@ -71,6 +80,13 @@ namespace MotorDrivers {
         set_disable(true);                              // turn off torque so we can set EEPROM registers
         set_operating_mode(DXL_CONTROL_MODE_POSITION);  // set it in the right control mode
 
+        if (_profile_velocity) {
+            dxl_read(DXL_VELOCITY_LIMIT, 4);
+            if (dxl_get_response(15) == 15) {
+                _velocity_limit = _rx_message[9] | (_rx_message[10] << 8) | (_rx_message[11] << 16) | (_rx_message[12] << 24);
+            }
+        }
+
         // servos will blink in axis order for reference
         LED_on(true);
         dwell_ms(100, DwellMode::SysSuspend);
@@ -134,12 +150,23 @@ namespace MotorDrivers {
         }
 
         start_message(DXL_BROADCAST_ID, DXL_SYNC_WRITE);
-        add_uint16(DXL_GOAL_POSITION);
-        add_uint16(4);  // data length
+        if (_profile_velocity) {
+            add_uint16(DXL_PROFILE_VELOCITY);
+            add_uint16(8);  // data length, profile velocity then goal position
+        } else {
+            add_uint16(DXL_GOAL_POSITION);
+            add_uint16(4);  // data length
+        }
 
-        float* mpos = get_mpos();
-        float  motors[MAX_N_AXIS];
-        config->_kinematics->transform_cartesian_to_motors(motors, mpos);
+        // Where the motors will be when the servos get there
+        uint32_t lead_ms = _lead_ms < 0 ? _timer_ms : _lead_ms;
+        int32_t  steps[MAX_N_AXIS];
+        float    motors[MAX_N_AXIS];
+        Stepper::predict_motor_steps(steps, lead_ms * 1000);
+        auto n_axis = config->_axes->_numberAxis;
+        for (int axis = 0; axis < n_axis; axis++) {
+            motors[axis] = steps_to_mpos(steps[axis], axis);
+        }
 
         for (const auto& instance : _instances) {
             float    dxl_count_min, dxl_count_max;
@@ -154,7 +181,11 @@ namespace MotorDrivers {
                 motors[axis_index], limitsMinPosition(axis_index), limitsMaxPosition(axis_index), dxl_count_min, dxl_count_max));
 
             add_uint8(instance->_id);  // ID of the servo
+            if (_profile_velocity) {
+                add_uint32(instance->profile_velocity(dxl_position));
+            }
             add_uint32(dxl_position);
+            instance->_last_position = dxl_position;
         }
         finish_message();
     }
@@ -162,6 +193,23 @@ namespace MotorDrivers {
         update_all();
     }
 
+    // The velocity, in units of 0.229 rev/min, that covers the distance to
+    // the new goal in one update period.  0 means no limit to a Dynamixel,
+    // so stopped servos get the slowest speed instead.
+    uint32_t Dynamixel2::profile_velocity(uint32_t goal) {
+        const float counts_per_rev = 4096;
+        const float rpm_per_unit   = 0.229f;
+
+        float    counts   = std::abs(int32_t(goal - _last_position));
+        float    rpm      = counts / counts_per_rev * 60000.0f / _timer_ms;
+        uint32_t velocity = uint32_t(rpm / rpm_per_unit) + 1;
+
+        if (_velocity_limit && velocity > _velocity_limit) {
+            velocity = _velocity_limit;
+        }
+        return velocity;
+    }
+
     void Dynamixel2::set_location() {}
 
     // This motor will not do a standard home to a limit switch (maybe future)
@@ -23,7 +23,9 @@ namespace MotorDrivers {
 
         uint8_t _id = 255;
 
-        static int _timer_ms;
+        static int  _timer_ms;
+        static int  _lead_ms;           // How far ahead of the steppers to command the servos, -1 for one update period
+        static bool _profile_velocity;  // Send a profile velocity that reaches each goal as the next one is sent
 
         static uint8_t _tx_message[100];  // outgoing to dynamixel
         static uint8_t _msg_index;
@@ -43,9 +45,10 @@ namespace MotorDrivers {
         uint32_t dxl_read_position();
         void     dxl_read(uint16_t address, uint16_t data_len);
 
-        void dxl_goal_position(int32_t position);  // set one motor
-        void set_operating_mode(uint8_t mode);
-        void LED_on(bool on);
+        void     dxl_goal_position(int32_t position);  // set one motor
+        uint32_t profile_velocity(uint32_t goal);
+        void     set_operating_mode(uint8_t mode);
+        void     LED_on(bool on);
 
         size_t dxl_get_response(uint16_t length);
 
@@ -88,8 +91,10 @@ namespace MotorDrivers {
 
         // protocol 2 register locations
         static const int DXL_OPERATING_MODE   = 11;
+        static const int DXL_VELOCITY_LIMIT   = 44;
         static const int DXL_ADDR_TORQUE_EN   = 64;
         static const int DXL_ADDR_LED_ON      = 65;
+        static const int DXL_PROFILE_VELOCITY = 112;  // 0x70, just ahead of the goal position
         static const int DXL_GOAL_POSITION    = 116;  // 0x74
         static const int DXL_PRESENT_POSITION = 132;  // 0x84
 
@@ -99,6 +104,9 @@ namespace MotorDrivers {
         uint32_t _countMin = 1024;
         uint32_t _countMax = 3072;
 
+        uint32_t _velocity_limit = 0;  // Read from the servo; the profile velocity may not exceed it
+        uint32_t _last_position  = 0;
+
         bool        _disabled = true;
         static bool _has_errors;
 
@@ -126,6 +134,8 @@ namespace MotorDrivers {
             handler.item("count_min", _countMin);
             handler.item("count_max", _countMax);
             handler.item("timer_ms", _timer_ms);
+            handler.item("lead_ms", _lead_ms, -1, 1000);
+            handler.item("profile_velocity", _profile_velocity);
 
             Servo::group(handler);
         }
@@ -46,4 +46,10 @@ namespace MotorDrivers {
     void IRAM_ATTR MotorDriver::set_direction(bool) {}
     void IRAM_ATTR MotorDriver::step() {}
     void IRAM_ATTR MotorDriver::unstep() {}
+    void IRAM_ATTR MotorDriver::step_burst(const uint8_t* events, size_t count, uint32_t period) {
+        while (count--) {
+            step();
+            unstep();
+        }
+    }
 }
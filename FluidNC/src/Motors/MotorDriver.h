@@ -80,6 +80,19 @@ namespace MotorDrivers {
         // states of the step pins are unknown.
         virtual void unstep();
 
+        // step_burst() starts a train of count step pulses for the
+        // RMT_burst and I2S_stream engines, at the given step events of a burst, period
+        // stepping timer ticks apart.  Drivers without a pulse generator
+        // take all of the steps at once.
+        virtual void step_burst(const uint8_t* events, size_t count, uint32_t period);
+
+        // stop_burst() drops whatever is left of a burst's pulse train.
+        virtual void stop_burst() {}
+
+        // paces_bursts() is false for drivers that need each step as it
+        // happens; bursts are one event long on machines that have them.
+        virtual bool paces_bursts() { return true; }
+
         // this is used to configure and test motors. This would be used for Trinamic
         virtual void config_motor() {}
 
@@ -13,6 +13,10 @@
 
     Homing simply sets the axis Mpos to the endpoint as determined by homing/mpos
 
+    Each update commands the position the axis will reach lead_ms from now,
+    taken from the stepper segment queue, so that the servo keeps up with
+    the stepper axes instead of trailing them by an update period.
+
 */
 
 #include "RcServo.h"
@@ -21,6 +25,7 @@
 #include "../System.h"  // mpos_to_steps() etc
 #include "../Pin.h"
 #include "../Limits.h"  // limitsMaxPosition
+#include "../Stepper.h"  // predict_motor_steps()
 #include "RcServoSettings.h"
 
 namespace MotorDrivers {
@@ -110,8 +115,12 @@ namespace MotorDrivers {
 
         read_settings();
 
-        float mpos = steps_to_mpos(get_axis_motor_steps(_axis_index), _axis_index);  // get the axis machine position in mm
-        servo_pos  = mpos;                                                           // determine the current work position
+        uint32_t lead_ms = _lead_ms < 0 ? _timer_ms : _lead_ms;
+        int32_t  steps[MAX_N_AXIS];
+        Stepper::predict_motor_steps(steps, lead_ms * 1000);
+
+        float mpos = steps_to_mpos(steps[_axis_index], _axis_index);  // get the axis machine position in mm
+        servo_pos  = mpos;                                            // determine the current work position
 
         // determine the pulse length
         servo_pulse_len = static_cast<uint32_t>(mapConstrain(
@@ -11,6 +11,7 @@ namespace MotorDrivers {
     class RcServo : public Servo {
     protected:
         int _timer_ms = 20;
+        int _lead_ms  = -1;  // How far ahead of the steppers to command the servo, -1 for one update period
 
         void config_message() override;
 
@@ -57,6 +58,7 @@ namespace MotorDrivers {
             handler.item("min_pulse_us", _min_pulse_us, SERVO_PULSE_US_MIN, SERVO_PULSE_US_MAX);
             handler.item("max_pulse_us", _max_pulse_us, SERVO_PULSE_US_MIN, SERVO_PULSE_US_MAX);
             handler.item("timer_ms", _timer_ms);
+            handler.item("lead_ms", _lead_ms, -1, 1000);
 
             Servo::group(handler);
         }
@@ -0,0 +1,298 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "StallGuardCalibration.h"
+
+#include "../Machine/MachineConfig.h"
+#include "../Machine/Homing.h"
+#include "../MotionControl.h"  // mc_linear
+#include "../Planner.h"        // plan_reset, plan_sync_position
+#include "../Protocol.h"       // protocol_execute_realtime
+#include "../GCode.h"          // gc_sync_position
+#include "../Stepper.h"        // get_realtime_rate
+#include "../System.h"         // get_mpos
+
+#include <algorithm>
+
+namespace MotorDrivers {
+    void StallGuardCalibration::Stats::add(uint16_t value) {
+        count++;
+        sum += value;
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+
+    Error StallGuardCalibration::run() {
+        auto axisConfig = config->_axes->_axis[_axis];
+        auto homing     = axisConfig->_homing;
+        char name       = config->_axes->axisName(_axis);
+
+        if (!homing) {
+            log_error(name << " axis has no homing section");
+            return Error::InvalidStatement;
+        }
+        for (auto motor : axisConfig->_motors) {
+            if (motor && motor->_hardLimits) {
+                log_error("Turn off hard_limits for the " << name << " axis while calibrating");
+                return Error::InvalidStatement;
+            }
+        }
+        for (auto driver : TrinamicBase::_instances) {
+            if (driver->axis_index() == _axis && driver->_homing_mode == StallGuard && !driver->_has_errors) {
+                int setting = driver->_stallguard;
+                _drivers.push_back({ driver, 0, {}, {}, 0, 0, setting, setting, setting });
+            }
+        }
+        if (_drivers.empty()) {
+            log_error("No Trinamic driver on the " << name << " axis has homing_mode StallGuard");
+            return Error::InvalidStatement;
+        }
+
+        const float feed_rate = homing->_feedRate;
+        const float seek_rate = homing->_seekRate;
+        _toward               = homing->_positiveDirection ? 1 : -1;
+
+        // Fastest first, so that the first approach from an unknown distance is short
+        std::vector<float> feeds;
+        for (float scale : { 4.0f, 2.0f, 1.0f, 0.5f }) {
+            float feed = std::min(feed_rate * scale, axisConfig->_maxRate);
+            if (feeds.empty() || feed < feeds.back()) {
+                feeds.push_back(feed);
+            }
+        }
+
+        AxisMask axisMask = bitnum_to_mask(_axis);
+        for (auto& d : _drivers) {
+            d.driver->_calibrating = true;
+        }
+
+        float best_feed   = 0;
+        float best_score  = 0;
+        float stop_travel = axisConfig->_maxTravel * homing->_seek_scaler;
+        bool  aborted     = false;
+
+        for (float feed : feeds) {
+            // The StallGuard velocity window follows the homing feed rate
+            homing->_feedRate = feed;
+
+            if (!free_run(feed)) {
+                aborted = true;
+                break;
+            }
+
+            for (auto& d : _drivers) {
+                d.stop = {};
+            }
+            float pulloff = free_distance(feed) / 2;
+            bool  stopped = move(_toward * stop_travel, feed, Phase::Stop);
+            if (sys.abort || !move(-_toward * pulloff, feed, Phase::Pulloff)) {
+                aborted = true;
+                break;
+            }
+            if (stopped) {
+                // The stop is now known to be pulloff away
+                stop_travel = 2 * pulloff;
+            }
+
+            float score;
+            evaluate(feed, stopped, score);
+            if (score > best_score) {
+                best_score = score;
+                best_feed  = feed;
+                for (auto& d : _drivers) {
+                    d.best_setting = d.setting;
+                }
+            }
+        }
+
+        for (auto& d : _drivers) {
+            d.driver->_calibrating = false;
+        }
+
+        // Steps were lost against the hard stop
+        Machine::Homing::set_axis_unhomed(_axis);
+
+        if (aborted || best_score == 0) {
+            homing->_feedRate = feed_rate;
+            homing->_seekRate = seek_rate;
+            for (auto& d : _drivers) {
+                d.driver->_stallguard = d.original;
+            }
+            config->_axes->set_homing_mode(axisMask, false);
+            if (!aborted) {
+                log_error(name << " no feed rate told free motion from the hard stop. Try a different homing_amps");
+            }
+            return aborted ? Error::Reset : Error::InvalidValue;
+        }
+
+        homing->_feedRate = best_feed;
+        homing->_seekRate = best_feed;
+        for (auto& d : _drivers) {
+            d.driver->_stallguard = d.best_setting;
+            log_info(name << " " << d.driver->name() << " stallguard:" << d.best_setting);
+        }
+        config->_axes->set_homing_mode(axisMask, false);
+        log_info(name << " homing feed_mm_per_min and seek_mm_per_min:" << best_feed << ". Save with $CD=<file>");
+        return Error::Ok;
+    }
+
+    // Write the stallguard values being tried
+    void StallGuardCalibration::apply() {
+        for (auto& d : _drivers) {
+            d.driver->_stallguard = d.setting;
+        }
+        config->_axes->set_homing_mode(bitnum_to_mask(_axis), true);
+    }
+
+    // Far enough for about free_run_ms at speed after accelerating, but
+    // no more than a quarter of the travel.
+    float StallGuardCalibration::free_distance(float feed) {
+        auto  axisConfig = config->_axes->_axis[_axis];
+        float speed      = feed / 60.0f;  // mm/sec
+        float distance   = speed * free_run_ms / 1000.0f + speed * speed / (2 * axisConfig->_acceleration);
+        return std::min(distance, axisConfig->_maxTravel / 4);
+    }
+
+    // Record SG_RESULT in free motion, away from the stop and back.  SPI
+    // drivers repeat it in a binary search for the lowest, most sensitive,
+    // SGT whose free motion readings stay above sgt_free_floor.
+    bool StallGuardCalibration::free_run(float feed) {
+        float distance = free_distance(feed);
+
+        for (auto& d : _drivers) {
+            if (uses_sgt(d.driver)) {
+                d.lo = -64;
+                d.hi = 63;
+            } else {
+                d.lo = d.hi = 0;  // No stall flags while measuring
+            }
+        }
+
+        bool searching = true;
+        while (searching) {
+            searching = false;
+            for (auto& d : _drivers) {
+                d.setting = d.lo + (d.hi - d.lo) / 2;
+                d.free    = {};
+            }
+            apply();
+            if (!move(-_toward * distance, feed, Phase::Free) || !move(_toward * distance, feed, Phase::Free)) {
+                return false;
+            }
+            for (auto& d : _drivers) {
+                if (d.lo == d.hi) {
+                    continue;
+                }
+                if (d.free.count && d.free.min >= sgt_free_floor) {
+                    d.hi = d.setting;
+                } else {
+                    d.lo = d.setting + 1;
+                }
+                searching = true;
+            }
+        }
+        return true;
+    }
+
+    // Score this feed rate by how well the worst driver on the axis tells
+    // free motion from the hard stop, and choose its setting.  Ties go to
+    // the faster rate.
+    void StallGuardCalibration::evaluate(float feed, bool stopped, float& score) {
+        char name = config->_axes->axisName(_axis);
+
+        score = stopped ? 1.0f : 0.0f;
+        for (auto& d : _drivers) {
+            float margin = 0;
+            if (!d.free.count || !d.stop.count) {
+                // Nothing to compare
+            } else if (uses_sgt(d.driver)) {
+                // SGT was chosen for free motion; the stop must read as a stall
+                margin = d.stop.min == 0 ? 1.0f : 0.0f;
+            } else if (d.free.min > d.stop.max) {
+                // Stall at half way between the readings, SG_RESULT <= 2 * SGTHRS
+                margin    = float(d.free.min - d.stop.max) / d.free.mean();
+                d.setting = std::min((d.stop.max + (d.free.min - d.stop.max) / 2) / 2, 255);
+            }
+            score = std::min(score, margin);
+
+            log_info(name << " " << d.driver->name() << " feed:" << feed << " stallguard:" << d.setting << " free SG min/mean/max:" << d.free.min
+                          << "/" << d.free.mean() << "/" << d.free.max << " stop SG min/max:" << d.stop.min << "/" << d.stop.max
+                          << (stopped ? "" : " stop not found") << " margin:" << margin);
+        }
+    }
+
+    // Move the axis by distance and record samples on the way.  A Stop
+    // move is cancelled once a driver has seen the stall; it returns true
+    // if that happened.  Other moves return false only on abort.
+    bool StallGuardCalibration::move(float distance, float feed, Phase phase) {
+        float target[MAX_N_AXIS];
+        float position[MAX_N_AXIS];
+        copyAxes(target, get_mpos());
+        copyAxes(position, target);
+        target[_axis] += distance;
+
+        plan_line_data_t plan_data      = {};
+        plan_data.motion.noFeedOverride = 1;
+        plan_data.spindle               = SpindleState::Disable;
+        plan_data.line_number           = Machine::Homing::REPORT_LINE_NUMBER;
+        plan_data.limits_checked        = true;  // The axis need not be homed
+        plan_data.feed_rate             = feed;
+
+        if (!mc_linear(target, &plan_data, position)) {
+            return false;
+        }
+
+        bool cancelled = false;
+        protocol_send_event(&cycleStartEvent);
+        do {
+            protocol_execute_realtime();
+            if (sys.abort) {
+                return false;
+            }
+            if (!cancelled && sample(phase, feed)) {
+                protocol_send_event(&motionCancelEvent);
+                cancelled = true;
+            }
+            delay_ms(1);
+        } while (!state_is(State::Idle));
+
+        // Discard the rest of a cancelled move, and take up lost steps
+        Stepper::reset();
+        plan_reset();
+        plan_sync_position();
+        gc_sync_position();
+
+        return phase == Phase::Stop ? cancelled : true;
+    }
+
+    // Record the samples taken since the last call, once the axis is up to
+    // speed.  Returns true when a Stop move has seen enough of the stall.
+    bool StallGuardCalibration::sample(Phase phase, float feed) {
+        if (phase == Phase::Pulloff) {
+            return false;
+        }
+        bool at_speed = Stepper::get_realtime_rate() >= feed * 0.9f;
+        bool done     = false;
+
+        for (auto& d : _drivers) {
+            TrinamicStatus s;
+            if (!d.driver->status(s) || s.time_ms == d.last_sample) {
+                continue;
+            }
+            d.last_sample = s.time_ms;
+
+            if (phase == Phase::Free) {
+                if (at_speed && !s.standstill) {
+                    d.free.add(s.sg_result);
+                }
+                continue;
+            }
+
+            // After the first stalled sample, keep every sample
+            if (d.stop.count || (at_speed && (s.stalled || s.sg_result <= d.free.min / 2))) {
+                d.stop.add(s.sg_result);
+                done = done || d.stop.count > stop_samples;
+            }
+        }
+        return done;
+    }
+}
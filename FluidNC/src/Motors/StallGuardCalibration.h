@@ -0,0 +1,78 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+    Sensorless homing calibration for Trinamic drivers, run by
+    $Motors/Calibrate=<axis>.
+
+    For each of a range of feed rates around the homing feed rate, the
+    axis makes a short run in free motion and then drives into the hard
+    stop at its homing end, while the status sampler records SG_RESULT.
+    SPI drivers get a search for the SGT value that keeps free motion
+    clear of a stall; SGT offsets SG_RESULT, so that a stall reads 0.  The
+    TMC2209 compares SG_RESULT with twice SGTHRS, so its threshold is put
+    between the free motion and hard stop readings.  The feed rate that
+    separates the two best becomes the homing feed and seek rate, and the
+    stallguard values are set to match.  Save them with $CD=<file>.
+
+    Park the axis away from both ends first: the free runs go up to a
+    quarter of max travel away from the homing end.  Hard limits must be
+    off for the axis, because a stall on a DIAG pin wired as a limit would
+    trip them.  The axis is unhomed afterwards.
+*/
+
+#include "TrinamicBase.h"
+#include "../Error.h"
+
+#include <vector>
+
+namespace MotorDrivers {
+    class StallGuardCalibration {
+    public:
+        StallGuardCalibration(size_t axis) : _axis(axis) {}
+
+        Error run();
+
+    private:
+        enum class Phase { Pulloff, Free, Stop };
+
+        struct Stats {
+            uint32_t count = 0;
+            uint32_t sum   = 0;
+            uint16_t min   = 0xFFFF;
+            uint16_t max   = 0;
+
+            void     add(uint16_t value);
+            uint16_t mean() const { return count ? sum / count : 0; }
+        };
+
+        struct Driver {
+            TrinamicBase* driver;
+            uint32_t      last_sample;  // time_ms of the last sample recorded
+            Stats         free;
+            Stats         stop;
+            int           lo, hi;  // SGT search range
+            int           setting;
+            int           best_setting;
+            int           original;
+        };
+
+        static const int      stop_samples   = 4;   // Samples past the first stalled one
+        static const uint16_t sgt_free_floor = 64;  // Free motion SG_RESULT to keep with SGT
+        static const int      free_run_ms    = 1500;
+
+        size_t              _axis;
+        std::vector<Driver> _drivers;
+        float               _toward;  // Sign of motion toward the hard stop
+
+        void  apply();
+        bool  move(float distance, float feed, Phase phase);
+        bool  sample(Phase phase, float feed);
+        float free_distance(float feed);
+        bool  free_run(float feed);
+        void  evaluate(float feed, bool stopped, float& score);
+
+        static bool uses_sgt(TrinamicBase* driver) { return driver->stallguard_setting() == TrinamicBase::StallGuardSetting::Sgt; }
+    };
+}
@@ -8,17 +8,26 @@
 #include "StandardStepper.h"
 
 #include "../Machine/MachineConfig.h"
+#include "../I2SOut.h"  // i2s_out_burst_step
 #include "../Stepper.h"   // ST_I2S_*
 #include "../Stepping.h"  // config->_stepping->_engine
 
 #include <esp32-hal-gpio.h>  // gpio
 #include <sdkconfig.h>       // CONFIG_IDF_TARGET_*
+#include <soc/rmt_struct.h>  // RMT, RMTMEM
 
 using namespace Machine;
 
 namespace MotorDrivers {
 
-    static void init_rmt_channel(rmt_channel_t& rmt_chan_num, Pin& step_pin, bool invert_step, uint32_t dir_delay_ms, uint32_t pulse_us) {
+    // RMT ticks are 1/4 us, the 80 MHz APB clock divided by rmt_clk_div
+    const uint8_t  rmt_clk_div              = 20;
+    const uint32_t rmt_ticks_per_us         = 80 / rmt_clk_div;
+    const uint32_t timer_ticks_per_rmt_tick = Stepping::fStepperTimer / 1000000 / rmt_ticks_per_us;
+    const uint32_t rmt_max_duration         = 0x7fff;  // 15 bits
+
+    // With burst, the channel gets one memory block, which step_burst() fills for each burst
+    static void init_rmt_channel(rmt_channel_t& rmt_chan_num, Pin& step_pin, bool invert_step, uint32_t dir_delay_ms, uint32_t pulse_us, bool burst) {
         static rmt_channel_t next_RMT_chan_num = RMT_CHANNEL_0;
         if (rmt_chan_num == RMT_CHANNEL_MAX) {
             if (next_RMT_chan_num == RMT_CHANNEL_MAX) {
@@ -34,8 +43,8 @@ namespace MotorDrivers {
         rmt_config_t rmtConfig = { .rmt_mode      = RMT_MODE_TX,
                                    .channel       = rmt_chan_num,
                                    .gpio_num      = gpio_num_t(step_pin_gpio),
-                                   .clk_div       = 20,
-                                   .mem_block_num = 2,
+                                   .clk_div       = rmt_clk_div,
+                                   .mem_block_num = uint8_t(burst ? 1 : 2),
                                    .flags         = 0,
                                    .tx_config     = {
                                        .carrier_freq_hz      = 0,
@@ -51,15 +60,17 @@ namespace MotorDrivers {
                                    } };
 
         rmt_item32_t rmtItem[2];
-        rmtItem[0].duration0 = dir_delay_ms ? dir_delay_ms * 4 : 1;
-        rmtItem[0].duration1 = 4 * pulse_us;
+        rmtItem[0].duration0 = dir_delay_ms ? dir_delay_ms * rmt_ticks_per_us : 1;
+        rmtItem[0].duration1 = rmt_ticks_per_us * pulse_us;
         rmtItem[1].duration0 = 0;
         rmtItem[1].duration1 = 0;
 
         rmtItem[0].level0 = rmtConfig.tx_config.idle_level;
         rmtItem[0].level1 = !rmtConfig.tx_config.idle_level;
         rmt_config(&rmtConfig);
-        rmt_fill_tx_items(rmtConfig.channel, &rmtItem[0], rmtConfig.mem_block_num, 0);
+        if (!burst) {
+            rmt_fill_tx_items(rmtConfig.channel, &rmtItem[0], rmtConfig.mem_block_num, 0);
+        }
     }
 
     void StandardStepper::init() {
@@ -78,10 +89,16 @@ namespace MotorDrivers {
         _dir_pin.setAttr(Pin::Attr::Output);
 
         auto stepping = config->_stepping;
-        if (stepping->_engine == Stepping::RMT) {
-            init_rmt_channel(_rmt_chan_num, _step_pin, _invert_step, stepping->_directionDelayUsecs, stepping->_pulseUsecs);
+        if (stepping->_engine == Stepping::RMT || stepping->_engine == Stepping::RMT_BURST) {
+            bool burst = stepping->_engine == Stepping::RMT_BURST;
+            init_rmt_channel(_rmt_chan_num, _step_pin, _invert_step, stepping->_directionDelayUsecs, stepping->_pulseUsecs, burst);
+            _rmt_dir_ticks   = stepping->_directionDelayUsecs * rmt_ticks_per_us;
+            _rmt_pulse_ticks = stepping->_pulseUsecs * rmt_ticks_per_us;
         } else {
             _step_pin.setAttr(Pin::Attr::Output);
+            if (stepping->_engine == Stepping::I2S_STREAM) {
+                _i2so_step_index = _step_pin.getNative(Pin::Capabilities::I2S);
+            }
         }
 
         if (_disable_pin.defined()) {
@@ -93,29 +110,105 @@ namespace MotorDrivers {
         log_info("    " << name() << " Step:" << _step_pin.name() << " Dir:" << _dir_pin.name() << " Disable:" << _disable_pin.name());
     }
 
-    void IRAM_ATTR StandardStepper::step() {
-        if (config->_stepping->_engine == Stepping::RMT && _rmt_chan_num != RMT_CHANNEL_MAX) {
+    // Send the items in the channel's memory from the start
+    void IRAM_ATTR StandardStepper::rmt_start() {
 #ifdef CONFIG_IDF_TARGET_ESP32
-            RMT.conf_ch[_rmt_chan_num].conf1.mem_rd_rst = 1;
-            RMT.conf_ch[_rmt_chan_num].conf1.mem_rd_rst = 0;
-            RMT.conf_ch[_rmt_chan_num].conf1.tx_start   = 1;
+        RMT.conf_ch[_rmt_chan_num].conf1.mem_rd_rst = 1;
+        RMT.conf_ch[_rmt_chan_num].conf1.mem_rd_rst = 0;
+        RMT.conf_ch[_rmt_chan_num].conf1.tx_start   = 1;
 #endif
 #ifdef CONFIG_IDF_TARGET_ESP32S3
-            RMT.chnconf0[_rmt_chan_num].mem_rd_rst_n = 1;
-            RMT.chnconf0[_rmt_chan_num].mem_rd_rst_n = 0;
-            RMT.chnconf0[_rmt_chan_num].tx_start_n   = 1;
+        RMT.chnconf0[_rmt_chan_num].mem_rd_rst_n = 1;
+        RMT.chnconf0[_rmt_chan_num].mem_rd_rst_n = 0;
+        RMT.chnconf0[_rmt_chan_num].tx_start_n   = 1;
 #endif
+    }
+
+    // Stop sending, leaving the output at its idle level
+    void StandardStepper::rmt_stop() {
+        RMTMEM.chan[_rmt_chan_num].data32[0].val = 0;
+#ifdef CONFIG_IDF_TARGET_ESP32
+        RMT.conf_ch[_rmt_chan_num].conf1.tx_start   = 0;
+        RMT.conf_ch[_rmt_chan_num].conf1.mem_rd_rst = 1;
+        RMT.conf_ch[_rmt_chan_num].conf1.mem_rd_rst = 0;
+#endif
+#ifdef CONFIG_IDF_TARGET_ESP32S3
+        RMT.chnconf0[_rmt_chan_num].tx_stop_n     = 1;
+        RMT.chnconf0[_rmt_chan_num].conf_update_n = 1;
+        RMT.chnconf0[_rmt_chan_num].mem_rd_rst_n  = 1;
+        RMT.chnconf0[_rmt_chan_num].mem_rd_rst_n  = 0;
+#endif
+    }
+
+    void StandardStepper::stop_burst() {
+        if (_rmt_chan_num != RMT_CHANNEL_MAX) {
+            rmt_stop();
+        }
+    }
+
+    void IRAM_ATTR StandardStepper::step() {
+        auto engine = config->_stepping->_engine;
+        if (engine == Stepping::RMT && _rmt_chan_num != RMT_CHANNEL_MAX) {
+            rmt_start();
+        } else if (engine == Stepping::RMT_BURST) {
+            const uint8_t now = 0;
+            step_burst(&now, 1, 0);
         } else {
             _step_pin.on();
         }
     }
 
     void IRAM_ATTR StandardStepper::unstep() {
-        if (config->_stepping->_engine != Stepping::RMT) {
+        auto engine = config->_stepping->_engine;
+        if (engine != Stepping::RMT && engine != Stepping::RMT_BURST) {
             _step_pin.off();
         }
     }
 
+    // Write a burst's pulse train into the channel's memory and send it.
+    // A pulse starts the direction delay after its step event.  The gap
+    // before a pulse can be longer than one item's duration, so it is
+    // padded with idle items; bursts of more than one event have periods
+    // of at most 16 bits, which leaves no more items than events, and the
+    // burst length keeps those within the memory block.  For I2S_stream,
+    // the step pin's events are marked for the I2S task to send instead.
+    void IRAM_ATTR StandardStepper::step_burst(const uint8_t* events, size_t count, uint32_t period) {
+        if (config->_stepping->_engine == Stepping::I2S_STREAM) {
+            i2s_out_burst_step(_i2so_step_index, events, count);
+            return;
+        }
+        if (_rmt_chan_num == RMT_CHANNEL_MAX) {
+            return;
+        }
+        const size_t max_items = Stepping::maxBurstEvents + 1;
+
+        auto         mem    = RMTMEM.chan[_rmt_chan_num].data32;
+        uint32_t     idle   = _invert_step;
+        size_t       n      = 0;
+        uint32_t     cursor = 0;  // RMT ticks from the start of the burst
+        rmt_item32_t item;
+        for (size_t i = 0; i < count && n < max_items; i++) {
+            uint32_t start = events[i] * period / timer_ticks_per_rmt_tick + _rmt_dir_ticks;
+            uint32_t gap   = start > cursor ? start - cursor : 1;
+            while (gap > rmt_max_duration && n < max_items) {
+                item.level0    = idle;
+                item.duration0 = rmt_max_duration / 2 + 1;
+                item.level1    = idle;
+                item.duration1 = rmt_max_duration / 2;
+                mem[n++].val   = item.val;
+                gap -= rmt_max_duration;
+            }
+            item.level0    = idle;
+            item.duration0 = gap;
+            item.level1    = !idle;
+            item.duration1 = _rmt_pulse_ticks;
+            mem[n++].val   = item.val;
+            cursor += gap + _rmt_pulse_ticks;
+        }
+        mem[n].val = 0;  // End marker
+        rmt_start();
+    }
+
     void IRAM_ATTR StandardStepper::set_direction(bool dir) { _dir_pin.write(dir); }
 
     void IRAM_ATTR StandardStepper::set_disable(bool disable) { _disable_pin.synchronousWrite(disable); }
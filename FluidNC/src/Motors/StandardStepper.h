@@ -20,6 +20,8 @@ namespace MotorDrivers {
         void set_direction(bool) override;
         void step() override;
         void unstep() override;
+        void step_burst(const uint8_t* events, size_t count, uint32_t period) override;
+        void stop_burst() override;
         void read_settings() override;
 
         void init_step_dir_pins();
@@ -46,5 +48,12 @@ namespace MotorDrivers {
         bool _invert_disable;
 
         rmt_channel_t _rmt_chan_num = RMT_CHANNEL_MAX;
+        uint32_t      _rmt_dir_ticks;    // Direction delay ahead of each RMT_burst pulse
+        uint32_t      _rmt_pulse_ticks;  // RMT_burst pulse width
+
+        pinnum_t _i2so_step_index = 0;  // I2SO bit of the step pin, for I2S_stream bursts
+
+        void rmt_start();
+        void rmt_stop();
     };
 }
@@ -80,23 +80,6 @@ namespace MotorDrivers {
         }
     }
 
-    // Report diagnostic and tuning info
-    void TMC2130Driver::debug_message() {
-        if (_has_errors) {
-            return;
-        }
-
-        uint32_t tstep = tmc2130->TSTEP();
-
-        if (tstep == 0xFFFFF || tstep < 1) {  // if axis is not moving return
-            return;
-        }
-        float feedrate = Stepper::get_realtime_rate();  //* settings.microsteps[axis_index] / 60.0 ; // convert mm/min to Hz
-
-        log_info(axisName() << " Stallguard " << tmc2130->stallguard() << "   SG_Val:" << tmc2130->sg_result() << " Rate:" << feedrate
-                            << " mm/min SG_Setting:" << constrain(_stallguard, -64, 63));
-    }
-
     void TMC2130Driver::set_disable(bool disable) {
         if (TrinamicSpiDriver::startDisable(disable)) {
             if (_use_enable) {
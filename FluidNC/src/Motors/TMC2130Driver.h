@@ -21,13 +21,13 @@ namespace MotorDrivers {
         void init() override;
         void set_disable(bool disable);
         void config_motor() override;
-        void debug_message() override;
         void validate() override { StandardStepper::validate(); }
 
     private:
         TMC2130Stepper* tmc2130 = nullptr;
 
-        bool test();
-        void set_registers(bool isHoming) override;
+        bool            test();
+        void            set_registers(bool isHoming) override;
+        TMC2130Stepper* spi_stepper() override { return tmc2130; }
     };
 }
@@ -21,15 +21,15 @@ namespace MotorDrivers {
         }
 
         tmc2208 = new TMC2209Stepper(_uart, _r_sense, _addr);
+        _bus->attach(tmc2208, select_pin());
 
         registration();
     }
 
     void TMC2208Driver::config_motor() {
-        _cs_pin.synchronousWrite(true);
+        _bus->forget(tmc2208);
         tmc2208->begin();
         TrinamicBase::config_motor();
-        _cs_pin.synchronousWrite(false);
     }
 
     void TMC2208Driver::set_registers(bool isHoming) {
@@ -44,8 +44,6 @@ namespace MotorDrivers {
         // and hold current as (float) fraction of run current.
         uint16_t run_i = (uint16_t)(_run_current * 1000.0);
 
-        _cs_pin.synchronousWrite(true);
-
         tmc2208->I_scale_analog(false);  // do not scale via pot
         tmc2208->rms_current(run_i, TrinamicBase::holdPercent());
 
@@ -56,26 +54,47 @@ namespace MotorDrivers {
         // This driver does not support multiple modes
         tmc2208->en_spreadCycle(false);
         tmc2208->pwm_autoscale(true);
+    }
 
-        _cs_pin.synchronousWrite(false);
+    // The TMC2208 has no StallGuard, so only the current and standstill are
+    // useful.  The read is queued and the sample is published when it completes.
+    bool TMC2208Driver::read_status(TrinamicStatus& status) {
+        read_mscnt();
+        if (_status_pending.exchange(true)) {
+            return false;  // The previous sample is still queued
+        }
+        _bus->post({ TrinamicUartBus::Kind::Read, _addr, DRV_STATUS_REG, 0, select_pin(), drv_status_done, this });
+        return false;
     }
 
-    void TMC2208Driver::debug_message() {}
+    void TMC2208Driver::drv_status_done(void* arg, bool ok, uint32_t data) {
+        auto driver = static_cast<TMC2208Driver*>(arg);
+        if (ok) {
+            TrinamicStatus status;
+            status.time_ms    = xTaskGetTickCount() * portTICK_PERIOD_MS;
+            status.drv_status = data;
+            status.sg_result  = 0;
+            status.cs_actual  = (data >> 16) & 0x1F;
+            status.stalled    = false;
+            status.standstill = (data >> 31) & 1;
+            driver->publish(status);
+        }
+        driver->_status_pending = false;
+    }
 
     void TMC2208Driver::set_disable(bool disable) {
-        _cs_pin.synchronousWrite(true);
         if (TrinamicUartDriver::startDisable(disable)) {
             if (_use_enable) {
                 tmc2208->toff(TrinamicUartDriver::toffValue());
+                if (!disable) {
+                    _bus->sync();  // The driver must be on before the first step
+                }
             }
         }
-        _cs_pin.synchronousWrite(false);
     }
 
     bool TMC2208Driver::test() {
-        _cs_pin.synchronousWrite(true);
         if (!checkVersion(0x20, tmc2208->version())) {
-            _cs_pin.synchronousWrite(false);
             return false;
         }
         uint8_t ifcnt_before = tmc2208->IFCNT();
@@ -84,10 +103,8 @@ namespace MotorDrivers {
         bool    okay        = ((ifcnt_before + 1) & 0xff) == ifcnt_after;
         if (!okay) {
             TrinamicBase::reportCommsFailure();
-            _cs_pin.synchronousWrite(false);
             return false;
         }
-        _cs_pin.synchronousWrite(false);
         return true;
     }
 
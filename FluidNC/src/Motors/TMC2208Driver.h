@@ -21,7 +21,6 @@ namespace MotorDrivers {
         void init() override;
         void set_disable(bool disable);
         void config_motor() override;
-        void debug_message() override;
         void validate() override { StandardStepper::validate(); }
 
         void group(Configuration::HandlerBase& handler) override {
@@ -38,5 +37,12 @@ namespace MotorDrivers {
 
         bool test();
         void set_registers(bool isHoming);
+        bool read_status(TrinamicStatus& status) override;
+
+        static const uint8_t DRV_STATUS_REG = 0x6F;
+
+        std::atomic<bool> _status_pending { false };  // A status sample is queued on the UART bus
+
+        static void drv_status_done(void* arg, bool ok, uint32_t data);
     };
 }
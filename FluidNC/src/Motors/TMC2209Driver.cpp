@@ -22,15 +22,15 @@ namespace MotorDrivers {
         }
 
         tmc2209 = new TMC2209Stepper(_uart, _r_sense, _addr);
+        _bus->attach(tmc2209, select_pin());
 
         registration();
     }
 
     void TMC2209Driver::config_motor() {
-        _cs_pin.synchronousWrite(true);
+        _bus->forget(tmc2209);
         tmc2209->begin();
         TrinamicBase::config_motor();
-        _cs_pin.synchronousWrite(false);
     }
 
     void TMC2209Driver::set_registers(bool isHoming) {
@@ -38,7 +38,7 @@ namespace MotorDrivers {
             return;
         }
 
-        TrinamicMode _mode = static_cast<TrinamicMode>(trinamicModes[isHoming ? _homing_mode : _run_mode].value);
+        _mode = static_cast<TrinamicMode>(trinamicModes[isHoming ? _homing_mode : _run_mode].value);
 
         // Run and hold current configuration items are in (float) Amps,
         // but the TMCStepper library expresses run current as (uint16_t) mA
@@ -46,8 +46,6 @@ namespace MotorDrivers {
         float    _mode_current = isHoming ? _homing_current : _run_current;
         uint16_t run_i         = (uint16_t)(_mode_current * 1000.0);
 
-        _cs_pin.synchronousWrite(true);
-
         tmc2209->I_scale_analog(false);  // do not scale via pot
         tmc2209->rms_current(run_i, TrinamicBase::holdPercent());
 
@@ -86,46 +84,56 @@ namespace MotorDrivers {
         log_verbose("GCONF: " << to_hex(tmc2209->GCONF()));
         log_verbose("PWMCONF: " << to_hex(tmc2209->PWMCONF()));
         log_verbose("IHOLD_IRUN: " << to_hex(tmc2209->IHOLD_IRUN()));
-
-        _cs_pin.synchronousWrite(false);
     }
 
-    void TMC2209Driver::debug_message() {
-        if (_has_errors) {
-            return;
+    // The sampler does not wait for the bus.  Both reads are queued and
+    // the sample is published when the second one completes.
+    bool TMC2209Driver::read_status(TrinamicStatus& status) {
+        read_mscnt();
+        if (_status_pending.exchange(true)) {
+            return false;  // The previous sample is still queued
         }
+        _bus->post({ TrinamicUartBus::Kind::Read, _addr, DRV_STATUS_REG, 0, select_pin(), drv_status_done, this });
+        _bus->post({ TrinamicUartBus::Kind::Read, _addr, SG_RESULT_REG, 0, select_pin(), sg_result_done, this });
+        return false;
+    }
 
-        _cs_pin.synchronousWrite(true);
-
-        uint32_t tstep = tmc2209->TSTEP();
-
-        if (tstep == 0xFFFFF || tstep < 1) {  // if axis is not moving return
-            _cs_pin.synchronousWrite(false);
-            return;
-        }
-        float feedrate = Stepper::get_realtime_rate();  //* settings.microsteps[axis_index] / 60.0 ; // convert mm/min to Hz
+    void TMC2209Driver::drv_status_done(void* arg, bool ok, uint32_t data) {
+        auto driver            = static_cast<TMC2209Driver*>(arg);
+        driver->_drv_status    = data;
+        driver->_drv_status_ok = ok;
+    }
 
-        if (tmc2209) {
-            log_info(axisName() << " SG_Val: " << tmc2209->SG_RESULT() << "   Rate: " << feedrate << " mm/min SG_Setting:" << _stallguard);
+    // The TMC2209 has no stall bit in DRV_STATUS.  DIAG goes high when
+    // SG_RESULT falls to twice the SGTHRS setting, so do the same.
+    void TMC2209Driver::sg_result_done(void* arg, bool ok, uint32_t data) {
+        auto driver = static_cast<TMC2209Driver*>(arg);
+        if (ok && driver->_drv_status_ok) {
+            TrinamicStatus status;
+            status.time_ms    = xTaskGetTickCount() * portTICK_PERIOD_MS;
+            status.drv_status = driver->_drv_status;
+            status.sg_result  = data;
+            status.cs_actual  = (driver->_drv_status >> 16) & 0x1F;
+            status.stalled    = driver->_mode == TrinamicMode::StallGuard && data <= 2 * uint32_t(driver->_stallguard);
+            status.standstill = (driver->_drv_status >> 31) & 1;
+            driver->publish(status);
         }
-
-        _cs_pin.synchronousWrite(false);
+        driver->_status_pending = false;
     }
 
     void TMC2209Driver::set_disable(bool disable) {
-        _cs_pin.synchronousWrite(true);
         if (TrinamicUartDriver::startDisable(disable)) {
             if (_use_enable) {
                 tmc2209->toff(TrinamicUartDriver::toffValue());
+                if (!disable) {
+                    _bus->sync();  // The driver must be on before the first step
+                }
             }
         }
-        _cs_pin.synchronousWrite(false);
     }
 
     bool TMC2209Driver::test() {
-        _cs_pin.synchronousWrite(true);
         if (!checkVersion(0x21, tmc2209->version())) {
-            _cs_pin.synchronousWrite(false);
             return false;
         }
 
@@ -135,10 +143,8 @@ namespace MotorDrivers {
         bool    okay        = ((ifcnt_before + 1) & 0xff) == ifcnt_after;
         if (!okay) {
             TrinamicBase::reportCommsFailure();
-            _cs_pin.synchronousWrite(false);
             return false;
         }
-        _cs_pin.synchronousWrite(false);
         return true;
     }
 
@@ -21,7 +21,6 @@ namespace MotorDrivers {
         void init() override;
         void set_disable(bool disable);
         void config_motor() override;
-        void debug_message() override;
         void validate() override { StandardStepper::validate(); }
 
         void group(Configuration::HandlerBase& handler) override {
@@ -48,5 +47,19 @@ namespace MotorDrivers {
 
         bool test();
         void set_registers(bool isHoming);
+        bool read_status(TrinamicStatus& status) override;
+
+        StallGuardSetting stallguard_setting() override { return StallGuardSetting::Sgthrs; }
+
+        static const uint8_t DRV_STATUS_REG = 0x6F;
+        static const uint8_t SG_RESULT_REG  = 0x41;
+
+        // A status sample in progress on the UART bus
+        std::atomic<bool> _status_pending { false };
+        uint32_t          _drv_status    = 0;
+        bool              _drv_status_ok = false;
+
+        static void drv_status_done(void* arg, bool ok, uint32_t data);
+        static void sg_result_done(void* arg, bool ok, uint32_t data);
     };
 }
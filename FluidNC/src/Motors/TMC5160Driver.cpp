@@ -89,23 +89,6 @@ namespace MotorDrivers {
         log_verbose("IHOLD_IRUN: " << to_hex(tmc5160->IHOLD_IRUN()));
     }
 
-    // Report diagnostic and tuning info
-    void TMC5160Driver::debug_message() {
-        if (_has_errors) {
-            return;
-        }
-
-        uint32_t tstep = tmc5160->TSTEP();
-
-        if (tstep == 0xFFFFF || tstep < 1) {  // if axis is not moving return
-            return;
-        }
-        float feedrate = Stepper::get_realtime_rate();  //* settings.microsteps[axis_index] / 60.0 ; // convert mm/min to Hz
-
-        log_info(axisName() << " Stallguard " << tmc5160->stallguard() << "   SG_Val:" << tmc5160->sg_result() << " Rate:" << feedrate
-                            << " mm/min SG_Setting:" << constrain(_stallguard, -64, 63));
-    }
-
     void TMC5160Driver::set_disable(bool disable) {
         if (TrinamicSpiDriver::startDisable(disable)) {
             if (_use_enable) {
@@ -20,7 +20,6 @@ namespace MotorDrivers {
         void init() override;
         void set_disable(bool disable);
         void config_motor() override;
-        void debug_message() override;
         void validate() override { StandardStepper::validate(); }
 
         void group(Configuration::HandlerBase& handler) override {
@@ -33,9 +32,10 @@ namespace MotorDrivers {
 
         uint8_t _tpfd = 4;
 
-        bool test();
-        void set_registers(bool isHoming);
-        void trinamic_test_response();
-        void trinamic_stepper_enable(bool enable);
+        bool            test();
+        void            set_registers(bool isHoming);
+        void            trinamic_test_response();
+        void            trinamic_stepper_enable(bool enable);
+        TMC2130Stepper* spi_stepper() override { return tmc5160; }
     };
 }
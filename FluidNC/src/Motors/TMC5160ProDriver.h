@@ -33,7 +33,6 @@ namespace MotorDrivers {
         void init() override;
         void set_disable(bool disable);
         void config_motor() override;
-        void debug_message() override;
         void validate() override { StandardStepper::validate(); }
 
         void group(Configuration::HandlerBase& handler) override {
@@ -43,6 +42,7 @@ namespace MotorDrivers {
             handler.item("spi_index", _spi_index, -1, 127);
 
             handler.item("use_enable", _use_enable);
+            handler.item("sample_ms", _sample_ms, 0, 10000);
             handler.item("CHOPCONF", CHOPCONF);
             handler.item("COOLCONF", COOLCONF);
             handler.item("THIGH", THIGH);
@@ -63,7 +63,8 @@ namespace MotorDrivers {
         uint32_t PWMCONF    = 3289120798;
         uint32_t IHOLD_IRUN = 7948;
 
-        bool test();
-        void set_registers(bool isHoming);
+        bool            test();
+        void            set_registers(bool isHoming);
+        TMC2130Stepper* spi_stepper() override { return tmc5160; }
     };
 }
@@ -3,6 +3,9 @@
 
 #include "TrinamicBase.h"
 #include "../Machine/MachineConfig.h"
+#include "../Stepper.h"      // get_realtime_rate()
+#include "../MotionControl.h"  // mc_critical()
+#include "Driver/tmc_spi.h"     // tmc_spi_read_chain()
 
 #include <atomic>
 
@@ -12,18 +15,230 @@ namespace MotorDrivers {
                                        { TrinamicMode::StallGuard, "StallGuard" },
                                        EnumItem(TrinamicMode::StealthChop) };
 
+    const EnumItem stepChecks[] = { { StepCheckOff, "Off" },
+                                    { StepCheckReport, "Report" },
+                                    { StepCheckAlarm, "Alarm" },
+                                    EnumItem(StepCheckOff) };
+
     std::vector<TrinamicBase*> TrinamicBase::_instances;  // static list of all drivers for stallguard reporting
 
-    // Another approach would be to register a separate timer for each instance.
-    // I think that timers are cheap so having only a single timer might not buy us much
-    void TrinamicBase::read_sg(TimerHandle_t timer) {
-        if (inMotionState()) {
+    const uint8_t DRV_STATUS_REG = 0x6F;
+
+    // sample_ms: 0 turns sampling off, but stallguard_debug and step_check need
+    // samples, and calibration needs them often.
+    TickType_t TrinamicBase::sample_period() {
+        int ms = _calibrating ? 10 : _sample_ms ? _sample_ms : (_stallguardDebugMode ? 200 : _step_check ? 100 : 0);
+        return ms ? std::max<TickType_t>(ms / portTICK_PERIOD_MS, 1) : 0;
+    }
+
+    // The status sampler runs in its own task so that slow register reads
+    // never hold up the timer task or a motion caller.  SPI drivers that are
+    // due are read together, which costs two transfers per daisy chain.  The
+    // results go to per-driver snapshots that any task can read.
+    void TrinamicBase::sampler(void*) {
+        std::vector<TrinamicBase*>   chained;
+        std::vector<TMC2130Stepper*> steppers;
+        std::vector<uint32_t>        values;
+        std::vector<int32_t>         pulses;
+
+        while (true) {
+            TickType_t now  = xTaskGetTickCount();
+            TickType_t wait = 1000 / portTICK_PERIOD_MS;
+
+            chained.clear();
+            steppers.clear();
             for (TrinamicBase* t : _instances) {
-                if (t->_stallguardDebugMode) {
-                    //log_info("SG:" << t->_stallguardDebugMode);
-                    t->debug_message();
+                TickType_t period = t->sample_period();
+                if (!period || t->_has_errors) {
+                    continue;
+                }
+                TickType_t elapsed = now - t->_last_sample;
+                if (elapsed < period) {
+                    wait = std::min(wait, period - elapsed);
+                    continue;
+                }
+                t->_last_sample = now;
+                wait            = std::min(wait, period);
+
+                auto stepper = t->spi_stepper();
+                if (stepper) {
+                    chained.push_back(t);
+                    steppers.push_back(stepper);
+                } else {
+                    TrinamicStatus status;
+                    if (t->read_status(status)) {
+                        t->publish(status);
+                    }
+                }
+            }
+
+            if (!steppers.empty()) {
+                values.resize(steppers.size());
+                tmc_spi_read_chain(steppers.data(), steppers.size(), DRV_STATUS_REG, values.data());
+                for (size_t i = 0; i < chained.size(); i++) {
+                    chained[i]->publish(spi_status(values[i]));
+                }
+
+                // MSCNT only means something if no pulse went out during the
+                // read.  RMT_burst counts a burst's pulses when it starts, so
+                // wait until the last one has gone out.
+                size_t n = 0;
+                pulses.clear();
+                bool sending = Stepper::burst_sending();
+                for (size_t i = 0; i < chained.size(); i++) {
+                    if (chained[i]->_step_check && !sending) {
+                        chained[n]  = chained[i];
+                        steppers[n] = steppers[i];
+                        pulses.push_back(chained[i]->pulses());
+                        n++;
+                    }
+                }
+                if (n) {
+                    tmc_spi_read_chain(steppers.data(), n, MSCNT_REG, values.data());
+                    for (size_t i = 0; i < n; i++) {
+                        if (chained[i]->pulses() == pulses[i]) {
+                            chained[i]->check_steps(pulses[i], values[i] & 0x3FF);
+                        }
+                    }
+                }
+            }
+
+            if (inMotionState()) {
+                for (TrinamicBase* t : _instances) {
+                    if (t->_stallguardDebugMode && t->_last_sample == now) {
+                        t->debug_message();
+                    }
                 }
             }
+
+            vTaskDelay(wait);
+        }
+    }
+
+    TrinamicStatus TrinamicBase::spi_status(uint32_t drv_status) {
+        TrinamicStatus status;
+        status.time_ms    = xTaskGetTickCount() * portTICK_PERIOD_MS;
+        status.drv_status = drv_status;
+        status.sg_result  = drv_status & 0x3FF;
+        status.cs_actual  = (drv_status >> 16) & 0x1F;
+        status.stalled    = (drv_status >> 24) & 1;
+        status.standstill = (drv_status >> 31) & 1;
+        return status;
+    }
+
+    void TrinamicBase::publish(const TrinamicStatus& status) {
+        _status_seq.fetch_add(1, std::memory_order_acq_rel);  // Odd while writing
+        _status = status;
+        _status_seq.fetch_add(1, std::memory_order_release);
+    }
+
+    bool TrinamicBase::status(TrinamicStatus& status) {
+        // If a higher priority reader interrupts the sampler mid-write, give up
+        // instead of spinning.
+        for (int tries = 0; tries < 3; tries++) {
+            uint32_t seq = _status_seq.load(std::memory_order_acquire);
+            if (seq & 1) {
+                continue;
+            }
+            status = _status;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq == _status_seq.load(std::memory_order_relaxed)) {
+                return seq != 0;
+            }
+        }
+        return false;
+    }
+
+    // Report diagnostic and tuning info from the latest sample
+    void TrinamicBase::debug_message() {
+        TrinamicStatus s;
+        if (_has_errors || !status(s) || s.standstill) {  // if axis is not moving return
+            return;
+        }
+        float feedrate = Stepper::get_realtime_rate();
+
+        log_info(axisName() << " Stallguard " << yn(s.stalled) << "   SG_Val:" << s.sg_result << " CS:" << s.cs_actual << " Rate:" << feedrate
+                            << " mm/min SG_Setting:" << _stallguard);
+    }
+
+    int32_t TrinamicBase::pulses() {
+        return _motor ? _motor->_pulses : 0;
+    }
+
+    // MSCNT is the driver's position in its 1024 count electrical cycle, and
+    // each step pulse moves it 256 / microsteps counts, so its movement since
+    // a reference reading must match the pulses sent since then.  A mismatch
+    // means the driver missed pulses or saw extra ones, from pulses that are
+    // too short, noise, or a driver reset.  Losses of a multiple of four full
+    // steps cannot be seen.  Interpolation to 256 microsteps can leave MSCNT
+    // up to a step behind until the motor settles, so only readings taken
+    // while the pulse count held still since the previous one are used.  The
+    // sign of MSCNT per pulse depends on the wiring, and is learned from the
+    // first move that tells the two apart.
+    void TrinamicBase::check_steps(int32_t pulses, uint16_t mscnt) {
+        if (pulses != _step_last_pulses) {
+            _step_last_pulses = pulses;
+            return;
+        }
+        if (!_step_ref_valid) {
+            _step_ref_pulses = pulses;
+            _step_ref_mscnt  = mscnt;
+            _step_ref_valid  = true;
+            return;
+        }
+
+        int  per_pulse = 256 / _microsteps;
+        auto error     = [&](int sign) {
+            int e = (int(mscnt) - int(_step_ref_mscnt) - sign * (pulses - _step_ref_pulses) * per_pulse) & 1023;
+            return e >= 512 ? e - 1024 : e;
+        };
+        int plus  = error(1);
+        int minus = error(-1);
+
+        int e;
+        if (_step_sign) {
+            e = _step_sign > 0 ? plus : minus;
+        } else if (std::abs(plus) < per_pulse && std::abs(minus) < per_pulse) {
+            return;  // Cannot tell the directions apart yet
+        } else if (std::abs(plus) < per_pulse) {
+            _step_sign = 1;
+            return;
+        } else if (std::abs(minus) < per_pulse) {
+            _step_sign = -1;
+            return;
+        } else {
+            e = std::abs(plus) < std::abs(minus) ? plus : minus;
+        }
+        if (std::abs(e) < per_pulse) {
+            return;
+        }
+
+        // Start over from here, so one loss is reported once
+        _step_ref_pulses = pulses;
+        _step_ref_mscnt  = mscnt;
+        _step_errors++;
+
+        log_warn(axisName() << " " << name() << " missed " << (e / per_pulse) << " steps. MSCNT:" << mscnt);
+        if (_step_check == StepCheckAlarm) {
+            mc_critical(ExecAlarm::StepLoss);
+        }
+    }
+
+    void TrinamicBase::report_status(Channel& out) {
+        for (TrinamicBase* t : _instances) {
+            TrinamicStatus s;
+            if (!t->status(s)) {
+                log_stream(out, t->axisName() << " " << t->name() << " no samples" << (t->_sample_ms ? "" : ", sample_ms is 0"));
+                continue;
+            }
+            std::string errors;
+            if (t->_step_check) {
+                errors = " StepErrors:" + std::to_string(t->_step_errors);
+            }
+            log_stream(out,
+                       t->axisName() << " " << t->name() << " SG:" << s.sg_result << " CS:" << s.cs_actual << " Stall:" << t->yn(s.stalled)
+                                     << " Standstill:" << t->yn(s.standstill) << " DRV_STATUS:" << to_hex(s.drv_status)
+                                     << " Age:" << (xTaskGetTickCount() * portTICK_PERIOD_MS - s.time_ms) << "ms" << errors);
         }
     }
 
@@ -140,6 +355,9 @@ namespace MotorDrivers {
     void TrinamicBase::config_motor() {
         _has_errors = !test();  // Try communicating with motor. Prints an error if there is a problem.
 
+        // The driver may have been reset, so take a new MSCNT reference
+        _step_ref_valid = false;
+
         init_step_dir_pins();
 
         if (_has_errors) {
@@ -148,20 +366,26 @@ namespace MotorDrivers {
 
         set_registers(false);
     }
+    void TrinamicBase::start_sampler() {
+        static bool started = false;
+        if (started || _instances.empty()) {
+            return;
+        }
+        started = true;
+        // Task failure is not fatal because you can still use the system
+        if (xTaskCreatePinnedToCore(sampler, "trinamic_status", 4096, nullptr, 1, nullptr, SUPPORT_TASK_CORE) != pdPASS) {
+            log_error("Failed to create Trinamic status task");
+        }
+    }
+
     void TrinamicBase::registration() {
         // Display the stepper library version message once, before the first
         // TMC config message.
         if (_instances.empty()) {
             log_debug("TMCStepper Library Ver. " << to_hex(TMCSTEPPER_VERSION));
-            auto timer = xTimerCreate("Stallguard", 200, true, nullptr, read_sg);
-            // Timer failure is not fatal because you can still use the system
-            if (!timer) {
-                log_error("Failed to create timer for stallguard");
-            } else if (xTimerStart(timer, 0) == pdFAIL) {
-                log_error("Failed to start timer for stallguard");
-            }
         }
 
+        _motor = config->_axes->_axis[axis_index()]->_motors[dual_axis_index()];
         _instances.push_back(this);
 
         config_message();
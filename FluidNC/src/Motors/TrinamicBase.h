@@ -6,8 +6,15 @@
 #include "StandardStepper.h"
 #include "../EnumItem.h"
 #include <TMCStepper.h>  // https://github.com/teemuatlut/TMCStepper
+#include <atomic>
 #include <cstdint>
 
+class Channel;
+
+namespace Machine {
+    class Motor;
+}
+
 namespace MotorDrivers {
 
     enum TrinamicMode {
@@ -18,12 +25,58 @@ namespace MotorDrivers {
 
     extern const EnumItem trinamicModes[];
 
+    // What to do when the driver's microstep counter disagrees with the step pulses sent
+    enum StepCheck {
+        StepCheckOff    = 0,
+        StepCheckReport = 1,  // Log it and count it in $Motors/Status
+        StepCheckAlarm  = 2,
+    };
+
+    extern const EnumItem stepChecks[];
+
+    // A snapshot of a driver's load and health, taken by the status sampler
+    struct TrinamicStatus {
+        uint32_t time_ms;     // When the sample was taken
+        uint32_t drv_status;  // Raw DRV_STATUS register
+        uint16_t sg_result;   // StallGuard load measurement, lower means more load
+        uint8_t  cs_actual;   // Actual motor current scale, 0..31
+        bool     stalled;
+        bool     standstill;
+    };
+
     class TrinamicBase : public StandardStepper {
+    public:
+        // How the stallguard setting relates to SG_RESULT
+        enum class StallGuardSetting {
+            Sgt,     // Offsets SG_RESULT so that a stall reads 0 (TMC2130, TMC5160)
+            Sgthrs,  // A stall is SG_RESULT <= 2 * SGTHRS (TMC2209)
+        };
+
     private:
-        static void read_sg(TimerHandle_t);
+        friend class StallGuardCalibration;
+
+        static void sampler(void*);
 
         static std::vector<TrinamicBase*> _instances;
 
+        // Written by one task, the sampler or a UART bus.  Readers retry
+        // while the sequence number is odd or changes under them.
+        TrinamicStatus        _status;
+        std::atomic<uint32_t> _status_seq { 0 };
+        TickType_t            _last_sample = 0;
+        bool                  _calibrating = false;  // Sample fast for StallGuardCalibration
+
+        TickType_t sample_period();
+
+        // Step-loss check state, used only by the task that reads MSCNT
+        Machine::Motor*       _motor            = nullptr;
+        bool                  _step_ref_valid   = false;
+        int32_t               _step_ref_pulses  = 0;
+        uint16_t              _step_ref_mscnt   = 0;
+        int32_t               _step_last_pulses = 0;
+        int                   _step_sign        = 0;  // MSCNT direction per pulse, once learned
+        std::atomic<uint32_t> _step_errors { 0 };
+
     protected:
         uint32_t calc_tstep(int percent);
 
@@ -45,6 +98,8 @@ namespace MotorDrivers {
         int   _microsteps          = 16;
         int   _stallguard          = 0;
         bool  _stallguardDebugMode = false;
+        int   _sample_ms           = 0;
+        int   _step_check          = StepCheckOff;
 
         uint8_t _toff_disable     = 0;
         uint8_t _toff_stealthchop = 5;
@@ -65,6 +120,25 @@ namespace MotorDrivers {
         bool         startDisable(bool disable);
         virtual void config_motor();
 
+        // SPI drivers return their TMCStepper object, so that drivers on
+        // a daisy chain can be sampled together.  Others read their own status.
+        virtual TMC2130Stepper* spi_stepper() { return nullptr; }
+        virtual bool            read_status(TrinamicStatus& status) { return false; }
+
+        virtual StallGuardSetting stallguard_setting() { return StallGuardSetting::Sgt; }
+
+        // Decode the DRV_STATUS layout shared by the SPI drivers
+        static TrinamicStatus spi_status(uint32_t drv_status);
+
+        // Drivers whose read_status() completes later publish the sample themselves
+        void publish(const TrinamicStatus& status);
+
+        // Compare an MSCNT reading with the step pulses sent, pulses() before and after the read
+        static const uint8_t MSCNT_REG = 0x6A;
+
+        int32_t pulses();
+        void    check_steps(int32_t pulses, uint16_t mscnt);
+
         const char* yn(bool v) { return v ? "Y" : "N"; }
 
         void registration();
@@ -72,6 +146,17 @@ namespace MotorDrivers {
     public:
         TrinamicBase(const char* name) : StandardStepper(name) {}
 
+        // The most recent sample, if there is one.  Safe to call from any task.
+        bool status(TrinamicStatus& status);
+
+        void debug_message() override;
+
+        static void report_status(Channel& out);
+
+        // Start the status sampler once every driver has registered, so that
+        // _instances and the UART buses no longer change under it.
+        static void start_sampler();
+
         void group(Configuration::HandlerBase& handler) override {
             StandardStepper::group(handler);
 
@@ -82,6 +167,8 @@ namespace MotorDrivers {
             handler.item("toff_disable", _toff_disable, 0, 15);
             handler.item("toff_stealthchop", _toff_stealthchop, 2, 15);
             handler.item("use_enable", _use_enable);
+            handler.item("sample_ms", _sample_ms, 0, 10000);
+            handler.item("step_check", _step_check, stepChecks);
         }
     };
 
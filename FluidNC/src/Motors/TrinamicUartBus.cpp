@@ -0,0 +1,357 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+/*
+    TMC2209 Datasheet, section 4 UART Single Wire Interface
+    https://www.trinamic.com/fileadmin/assets/Products/ICs_Documents/TMC2209_Datasheet_V103.pdf
+*/
+
+#include "TrinamicUartBus.h"
+
+#include "../Config.h"
+#include "../Logging.h"
+
+#include <TMCStepper.h>  // https://github.com/teemuatlut/TMCStepper
+#include <string>
+
+namespace MotorDrivers {
+    namespace {
+        const uint8_t    SYNC        = 0x05;
+        const uint8_t    MASTER_ADDR = 0xFF;
+        const TickType_t tx_ticks    = 100 / portTICK_PERIOD_MS;
+        const TickType_t reply_ticks = 5 / portTICK_PERIOD_MS + 1;  // The reply starts 8 bit times after the request
+
+        // Configuration registers that only change when we write them
+        const uint8_t shadowed[] = {
+            0x00,  // GCONF
+            0x03,  // SLAVECONF
+            0x10,  // IHOLD_IRUN
+            0x11,  // TPOWERDOWN
+            0x13,  // TPWMTHRS
+            0x14,  // TCOOLTHRS
+            0x40,  // SGTHRS
+            0x42,  // COOLCONF
+            0x6C,  // CHOPCONF
+            0x70,  // PWMCONF
+        };
+
+        int shadowIndex(uint8_t reg) {
+            for (size_t i = 0; i < sizeof(shadowed); i++) {
+                if (shadowed[i] == reg) {
+                    return i;
+                }
+            }
+            return -1;
+        }
+
+        // CRC8 with polynomial x^8 + x^2 + x + 1, bytes shifted in LSB first
+        uint8_t crc8(const uint8_t* datagram, size_t len) {
+            uint8_t crc = 0;
+            for (size_t i = 0; i < len; i++) {
+                uint8_t byte = datagram[i];
+                for (int j = 0; j < 8; j++) {
+                    if ((crc >> 7) ^ (byte & 0x01)) {
+                        crc = (crc << 1) ^ 0x07;
+                    } else {
+                        crc = crc << 1;
+                    }
+                    byte >>= 1;
+                }
+            }
+            return crc;
+        }
+
+        // Completion for the blocking calls
+        struct Reply {
+            SemaphoreHandle_t done;
+            bool              ok;
+            uint32_t          data;
+        };
+
+        void complete(void* arg, bool ok, uint32_t data) {
+            auto reply  = static_cast<Reply*>(arg);
+            reply->ok   = ok;
+            reply->data = data;
+            xSemaphoreGive(reply->done);
+        }
+    }
+
+    std::vector<TrinamicUartBus*> TrinamicUartBus::_buses;
+    std::mutex                    TrinamicUartBus::_buses_mutex;
+
+    TrinamicUartBus::TrinamicUartBus(Uart* uart) : _uart(uart) {
+        // FreeRTOS copies the name, so a temporary is fine
+        std::string name("tmc_");
+        name += _uart->name();
+
+        _queue = xQueueCreate(queue_size, sizeof(Transaction));
+        _done  = xSemaphoreCreateBinary();
+        xTaskCreatePinnedToCore(task,          // task
+                                name.c_str(),  // name for task
+                                2048,          // size of task stack
+                                this,          // parameters
+                                1,             // priority
+                                nullptr,
+                                SUPPORT_TASK_CORE  // core
+        );
+    }
+
+    TrinamicUartBus* TrinamicUartBus::get(Uart* uart) {
+        // init can happen many times, we only want to start one task per bus
+        std::lock_guard<std::mutex> lock(_buses_mutex);
+        for (auto bus : _buses) {
+            if (bus->_uart == uart) {
+                return bus;
+            }
+        }
+        auto bus = new TrinamicUartBus(uart);
+        _buses.push_back(bus);
+        return bus;
+    }
+
+    TrinamicUartBus* TrinamicUartBus::find(const Stream* stream) {
+        std::lock_guard<std::mutex> lock(_buses_mutex);
+        for (auto bus : _buses) {
+            if (static_cast<const Stream*>(bus->_uart) == stream) {
+                return bus;
+            }
+        }
+        return nullptr;
+    }
+
+    void TrinamicUartBus::sync_all() {
+        // sync() blocks on the bus task, so do not hold the lock meanwhile
+        std::vector<TrinamicUartBus*> buses;
+        {
+            std::lock_guard<std::mutex> lock(_buses_mutex);
+            buses = _buses;
+        }
+        for (auto bus : buses) {
+            bus->sync();
+        }
+    }
+
+    TrinamicUartBus::Shadow& TrinamicUartBus::shadowFor(const TMC2208Stepper* driver) {
+        for (auto& shadow : _shadows) {
+            if (shadow.driver == driver) {
+                return shadow;
+            }
+        }
+        _shadows.push_back({ driver, nullptr, 0, {} });
+        return _shadows.back();
+    }
+
+    void TrinamicUartBus::attach(const TMC2208Stepper* driver, const Pin* cs) {
+        std::lock_guard<std::mutex> lock(_shadow_mutex);
+        Shadow&                     shadow = shadowFor(driver);
+        shadow.cs                          = cs;
+        shadow.valid                       = 0;
+    }
+
+    void TrinamicUartBus::forget(const TMC2208Stepper* driver) {
+        std::lock_guard<std::mutex> lock(_shadow_mutex);
+        shadowFor(driver).valid = 0;
+    }
+
+    const Pin* TrinamicUartBus::csFor(const TMC2208Stepper* driver) {
+        std::lock_guard<std::mutex> lock(_shadow_mutex);
+        return shadowFor(driver).cs;
+    }
+
+    bool TrinamicUartBus::cached(const TMC2208Stepper* driver, uint8_t reg, uint32_t& data) {
+        int index = shadowIndex(reg);
+        if (index < 0) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(_shadow_mutex);
+        Shadow&                     shadow = shadowFor(driver);
+        if (!(shadow.valid & (1 << index))) {
+            return false;
+        }
+        data = shadow.value[index];
+        return true;
+    }
+
+    bool TrinamicUartBus::remember(const TMC2208Stepper* driver, uint8_t reg, uint32_t data) {
+        int index = shadowIndex(reg);
+        if (index < 0) {
+            return true;
+        }
+        std::lock_guard<std::mutex> lock(_shadow_mutex);
+        Shadow&                     shadow = shadowFor(driver);
+        if ((shadow.valid & (1 << index)) && shadow.value[index] == data) {
+            return false;
+        }
+        shadow.value[index] = data;
+        shadow.valid |= 1 << index;
+        return true;
+    }
+
+    void TrinamicUartBus::post(const Transaction& transaction) {
+        xQueueSend(_queue, &transaction, portMAX_DELAY);
+    }
+
+    // Do not call the blocking forms from a callback; the bus task would wait for itself.
+    bool TrinamicUartBus::read(uint8_t addr, uint8_t reg, const Pin* cs, uint32_t& data) {
+        std::lock_guard<std::mutex> lock(_caller_mutex);
+
+        Reply reply = { _done, false, 0 };
+        post({ Kind::Read, addr, reg, 0, cs, complete, &reply });
+        xSemaphoreTake(_done, portMAX_DELAY);
+        data = reply.data;
+        return reply.ok;
+    }
+
+    void TrinamicUartBus::sync() {
+        std::lock_guard<std::mutex> lock(_caller_mutex);
+
+        Reply reply = { _done, false, 0 };
+        post({ Kind::Fence, 0, 0, 0, nullptr, complete, &reply });
+        xSemaphoreTake(_done, portMAX_DELAY);
+    }
+
+    void TrinamicUartBus::select(const Pin* cs, bool on) {
+        if (cs) {
+            cs->synchronousWrite(on);
+        }
+    }
+
+    // Writes have no reply, so the following writes behind the same select
+    // pin go out in the same UART write.  Their echo, if the wiring has one,
+    // is discarded before the next read.
+    void TrinamicUartBus::sendWrites(const Transaction& first) {
+        uint8_t     out[max_burst * 8];
+        Transaction sent[max_burst];
+        size_t      n = 0;
+
+        Transaction t = first;
+        while (true) {
+            uint8_t* datagram = &out[n * 8];
+            datagram[0]       = SYNC;
+            datagram[1]       = t.addr;
+            datagram[2]       = t.reg | 0x80;
+            datagram[3]       = t.data >> 24;
+            datagram[4]       = t.data >> 16;
+            datagram[5]       = t.data >> 8;
+            datagram[6]       = t.data;
+            datagram[7]       = crc8(datagram, 7);
+            sent[n++]         = t;
+
+            Transaction next;
+            if (n == max_burst || !xQueuePeek(_queue, &next, 0) || next.kind != Kind::Write || next.cs != first.cs) {
+                break;
+            }
+            xQueueReceive(_queue, &t, 0);
+        }
+
+        select(first.cs, true);
+        _uart->write(out, n * 8);
+        _uart->flushTxTimed(tx_ticks);
+        select(first.cs, false);
+
+        for (size_t i = 0; i < n; i++) {
+            if (sent[i].callback) {
+                sent[i].callback(sent[i].arg, true, 0);
+            }
+        }
+    }
+
+    // The reply is 8 bytes: sync, master address, register, 4 data bytes
+    // and the CRC.  On single wire boards the request echoes back first,
+    // so scan for the start of the reply instead of counting bytes.
+    bool TrinamicUartBus::transactRead(const Transaction& t, uint32_t& data) {
+        uint8_t request[4] = { SYNC, t.addr, t.reg, 0 };
+        request[3]         = crc8(request, 3);
+
+        const uint32_t header = (SYNC << 16) | (MASTER_ADDR << 8) | t.reg;
+
+        select(t.cs, true);
+        bool ok = false;
+        for (int attempt = 0; attempt <= max_retries && !ok; attempt++) {
+            _uart->flushRx();
+            _uart->write(request, sizeof(request));
+            _uart->flushTxTimed(tx_ticks);
+
+            uint64_t window = 0;
+            for (size_t count = 1; count <= sizeof(request) + 8; count++) {
+                uint8_t c;
+                if (_uart->timedReadBytes(&c, 1, reply_ticks) != 1) {
+                    break;
+                }
+                window = (window << 8) | c;
+                if (count >= 8 && (window >> 40) == header) {
+                    uint8_t reply[8];
+                    for (int i = 0; i < 8; i++) {
+                        reply[i] = window >> (56 - 8 * i);
+                    }
+                    ok   = crc8(reply, 7) == reply[7];
+                    data = uint32_t(window >> 8);
+                    break;
+                }
+            }
+        }
+        select(t.cs, false);
+        return ok;
+    }
+
+    void TrinamicUartBus::task(void* pvParameters) {
+        TrinamicUartBus* bus = static_cast<TrinamicUartBus*>(pvParameters);
+
+        Transaction t;
+        for (; true;) {
+            if (!xQueueReceive(bus->_queue, &t, portMAX_DELAY)) {
+                continue;
+            }
+            switch (t.kind) {
+                case Kind::Write:
+                    bus->sendWrites(t);
+                    break;
+                case Kind::Read: {
+                    uint32_t data = 0;
+                    bool     ok   = bus->transactRead(t, data);
+                    if (t.callback) {
+                        t.callback(t.arg, ok, data);
+                    }
+                    break;
+                }
+                case Kind::Fence:
+                    t.callback(t.arg, true, 0);
+                    break;
+            }
+        }
+    }
+}
+
+using MotorDrivers::TrinamicUartBus;
+
+// Replace the library's weak definition of TMC2208Stepper::write(), which
+// waits a fixed delay after every datagram.  Writes are queued instead.
+void TMC2208Stepper::write(uint8_t reg, uint32_t data) {
+    auto bus = TrinamicUartBus::find(HWSerial);
+    if (!bus) {
+        return;
+    }
+    if (!bus->remember(this, reg, data)) {
+        return;  // The chip already has this value
+    }
+    log_verbose("TMC reg " << to_hex(reg) << " write " << to_hex(data));
+    bus->post({ TrinamicUartBus::Kind::Write, slave_address, reg, data, bus->csFor(this), nullptr, nullptr });
+}
+
+// Replace the library's weak definition of TMC2208Stepper::read()
+uint32_t TMC2208Stepper::read(uint8_t reg) {
+    auto bus = TrinamicUartBus::find(HWSerial);
+    if (!bus) {
+        return 0;
+    }
+    uint32_t data;
+    if (bus->cached(this, reg, data)) {
+        return data;
+    }
+    if (!bus->read(slave_address, reg, bus->csFor(this), data)) {
+        CRCerror = true;
+        return 0;
+    }
+    log_verbose("TMC reg " << to_hex(reg) << " read " << to_hex(data));
+    bus->remember(this, reg, data);
+    return data;
+}
@@ -0,0 +1,109 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+    Transaction scheduler for Trinamic UART drivers (TMC2208, TMC2209).
+    There is one bus per UART, and its task owns the UART.  Transactions
+    for every driver on the bus go through one queue, in order.  Writes
+    need no reply, so consecutive writes go out back to back in a single
+    UART write, even to different drivers.  Reads wait for their reply
+    datagram and then complete through a callback.
+
+    The TMCStepper library's TMC2208Stepper::read() and write() are
+    replaced so that its register accessors use this queue: writes are
+    posted without waiting, reads post and wait.  Configuration registers
+    are shadowed, so the library's read-modify-write setters do not wait
+    for the bus at all, and rewriting an unchanged value is skipped.
+*/
+
+#include "../Uart.h"
+#include "../Pin.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class TMC2208Stepper;
+
+namespace MotorDrivers {
+    class TrinamicUartBus {
+    public:
+        // Called from the bus task.  ok is false if a read got no valid reply.
+        using Callback = void (*)(void* arg, bool ok, uint32_t data);
+
+        enum class Kind : uint8_t { Read, Write, Fence };
+
+        struct Transaction {
+            Kind       kind;
+            uint8_t    addr;
+            uint8_t    reg;
+            uint32_t   data;
+            const Pin* cs;  // Multiplexer select, or nullptr
+            Callback   callback;
+            void*      arg;
+        };
+
+        // Returns the bus for the uart, starting its task the first time.
+        static TrinamicUartBus* get(Uart* uart);
+
+        // Wait until every bus has sent everything queued so far
+        static void sync_all();
+
+        // Register a driver's select pin, and forget its shadowed registers
+        void attach(const TMC2208Stepper* driver, const Pin* cs);
+        void forget(const TMC2208Stepper* driver);
+
+        // Queue a transaction without waiting for it
+        void post(const Transaction& transaction);
+
+        // Blocking forms
+        bool read(uint8_t addr, uint8_t reg, const Pin* cs, uint32_t& data);
+        void sync();
+
+    private:
+        TrinamicUartBus(Uart* uart);
+
+        static const int queue_size  = 32;
+        static const int max_retries = 2;
+        static const int max_burst   = 8;  // Writes sent in one UART write
+
+        static std::vector<TrinamicUartBus*> _buses;
+        static std::mutex                    _buses_mutex;  // find() runs on any task while get() adds buses
+
+        Uart*             _uart;
+        QueueHandle_t     _queue = nullptr;
+        SemaphoreHandle_t _done  = nullptr;  // Given when a blocking caller's transaction completes
+        std::mutex        _caller_mutex;     // One blocking caller at a time
+
+        struct Shadow {
+            const TMC2208Stepper* driver;
+            const Pin*            cs;
+            uint16_t              valid;
+            uint32_t              value[10];
+        };
+        std::vector<Shadow> _shadows;
+        std::mutex          _shadow_mutex;
+
+        static void task(void* pvParameters);
+
+        void select(const Pin* cs, bool on);
+        void sendWrites(const Transaction& first);
+        bool transactRead(const Transaction& t, uint32_t& data);
+
+        Shadow& shadowFor(const TMC2208Stepper* driver);
+
+        // For the replacement TMC2208Stepper::read() and write()
+        friend class ::TMC2208Stepper;
+        static TrinamicUartBus* find(const Stream* stream);
+
+        const Pin* csFor(const TMC2208Stepper* driver);
+        bool       cached(const TMC2208Stepper* driver, uint8_t reg, uint32_t& data);
+        bool       remember(const TMC2208Stepper* driver, uint8_t reg, uint32_t data);  // false if unchanged
+    };
+}
@@ -24,6 +24,8 @@ namespace MotorDrivers {
         Assert(_uart, "TMC Driver missing uart%d section", _uart_num);
 
         _cs_pin.setAttr(Pin::Attr::Output);
+
+        _bus = TrinamicUartBus::get(_uart);
     }
 
     /*
@@ -43,4 +45,21 @@ namespace MotorDrivers {
         return _mode == TrinamicMode::StealthChop ? _toff_stealthchop : _toff_coolstep;
     }
 
+    void TrinamicUartDriver::read_mscnt() {
+        if (!_step_check || _mscnt_pending.exchange(true)) {
+            return;
+        }
+        _mscnt_pulses = pulses();
+        _bus->post({ TrinamicUartBus::Kind::Read, _addr, MSCNT_REG, 0, select_pin(), mscnt_done, this });
+    }
+
+    // MSCNT only means something if no pulse went out while the read was queued
+    void TrinamicUartDriver::mscnt_done(void* arg, bool ok, uint32_t data) {
+        auto driver = static_cast<TrinamicUartDriver*>(arg);
+        if (ok && driver->pulses() == driver->_mscnt_pulses) {
+            driver->check_steps(driver->_mscnt_pulses, data & 0x3FF);
+        }
+        driver->_mscnt_pending = false;
+    }
+
 }
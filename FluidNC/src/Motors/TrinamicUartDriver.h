@@ -5,6 +5,7 @@
 #pragma once
 
 #include "TrinamicBase.h"
+#include "TrinamicUartBus.h"
 #include "../Pin.h"
 #include "../Uart.h"
 
@@ -37,7 +38,8 @@ namespace MotorDrivers {
         }
 
     protected:
-        Uart* _uart = nullptr;
+        Uart*            _uart = nullptr;
+        TrinamicUartBus* _bus  = nullptr;
 
         Pin _cs_pin;
 
@@ -48,7 +50,18 @@ namespace MotorDrivers {
 
         uint8_t toffValue();  // TO DO move to Base?
 
+        // The multiplexer select for the bus, if there is one.  Drivers without
+        // one share nullptr, so their writes can go out together.
+        const Pin* select_pin() { return _cs_pin.defined() ? &_cs_pin : nullptr; }
+
+        // Queue an MSCNT read for check_steps(), if step_check is on
+        void read_mscnt();
+
     private:
+        std::atomic<bool> _mscnt_pending { false };
+        int32_t           _mscnt_pulses = 0;
+
+        static void mscnt_done(void* arg, bool ok, uint32_t data);
     };
 
 }
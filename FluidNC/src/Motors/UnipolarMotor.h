@@ -16,6 +16,7 @@ namespace MotorDrivers {
         void set_disable(bool disable) override;
         void set_direction(bool) override;
         void step() override;
+        bool paces_bursts() override { return false; }  // A burst would skip phases
 
         // Configuration handlers:
         void validate() override {
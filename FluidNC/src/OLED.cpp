@@ -2,6 +2,8 @@
 
 #include "Machine/MachineConfig.h"
 
+#include <cstring>
+
 void OLED::show(Layout& layout, const char* msg) {
     if (_width < layout._width_required) {
         return;
@@ -283,24 +285,13 @@ void OLED::parse_status_report() {
                     case 'P':
                         probe = true;
                         break;
-                    case 'X':
-                        limits[X_AXIS] = true;
-                        break;
-                    case 'Y':
-                        limits[Y_AXIS] = true;
-                        break;
-                    case 'Z':
-                        limits[Z_AXIS] = true;
-                        break;
-                    case 'A':
-                        limits[A_AXIS] = true;
-                        break;
-                    case 'B':
-                        limits[B_AXIS] = true;
-                        break;
-                    case 'C':
-                        limits[C_AXIS] = true;
+                    default: {
+                        const char* name = strchr(Machine::Axes::_names, c);
+                        if (name && name - Machine::Axes::_names < MAX_N_AXIS) {
+                            limits[name - Machine::Axes::_names] = true;
+                        }
                         break;
+                    }
                 }
                 continue;
             }
@@ -50,9 +50,9 @@ const std::map<const std::string, int> work_positions = {
     { "_a", 3 },
     { "_b", 4 },
     { "_c", 5 },
-    //    { "_u", 0},
-    //    { "_v", 0},
-    //    { "_w", 0},
+    { "_u", 6 },
+    { "_v", 7 },
+    { "_w", 8 },
 };
 const std::map<const std::string, int> machine_positions = {
     { "_abs_x", 0 },
@@ -61,9 +61,9 @@ const std::map<const std::string, int> machine_positions = {
     { "_abs_a", 3 },
     { "_abs_b", 4 },
     { "_abs_c", 5 },
-    //    { "_abs_u", 0},
-    //    { "_abs_v", 0},
-    //    { "_abs_w", 0},
+    { "_abs_u", 6 },
+    { "_abs_v", 7 },
+    { "_abs_w", 8 },
 };
 
 const std::array<const std::string, 6> unsupported_sys = {
@@ -237,12 +237,12 @@ bool get_system_param(const std::string& name, float& result) {
     for (auto const& c : name) {
         sysn += tolower(c);
     }
-    if (auto search = work_positions.find(sysn); search != work_positions.end()) {
+    if (auto search = work_positions.find(sysn); search != work_positions.end() && is_axis(search->second)) {
         auto axis = search->second;
         result    = to_inches(axis, get_mpos()[axis] - get_wco()[axis]);
         return true;
     }
-    if (auto search = machine_positions.find(sysn); search != machine_positions.end()) {
+    if (auto search = machine_positions.find(sysn); search != machine_positions.end() && is_axis(search->second)) {
         auto axis = search->second;
         result    = to_inches(axis, get_mpos()[axis]);
         return true;
@@ -74,7 +74,7 @@ void Parking::setup() {
     } else {
         saved_coolant       = gc_state.modal.coolant;
         saved_spindle       = gc_state.modal.spindle;
-        saved_spindle_speed = gc_state.spindle_speed;
+        saved_spindle_speed = gc_spindle_rpm();
     }
 }
 
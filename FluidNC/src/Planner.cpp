@@ -252,7 +252,7 @@ float plan_compute_profile_nominal_speed(plan_block_t* block) {
         nominal_speed *= (0.01f * sys.r_override);
     } else {
         if (!(block->motion.noFeedOverride)) {
-            nominal_speed *= (0.01f * sys.f_override);
+            nominal_speed *= feed_override_scale();
         }
         if (nominal_speed > block->rapid_rate) {
             nominal_speed = block->rapid_rate;
@@ -308,6 +308,7 @@ bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
     block->spindle_speed = pl_data->spindle_speed;
     block->line_number   = pl_data->line_number;
     block->is_jog        = pl_data->is_jog;
+    block->raster        = pl_data->raster;
 
     // Compute and store initial move distance data.
     int32_t target_steps[MAX_N_AXIS], position_steps[MAX_N_AXIS];
@@ -350,6 +351,12 @@ bool plan_buffer_line(float* target, plan_line_data_t* pl_data) {
     block->millimeters  = convert_delta_vector_to_unit_vector(unit_vec);
     block->acceleration = limit_acceleration_by_axis_maximum(unit_vec);
     block->rapid_rate   = limit_rate_by_axis_maximum(unit_vec);
+    if (pl_data->css_surface_speed > 0.0f) {
+        block->css_surface_speed = pl_data->css_surface_speed;
+        block->css_max_speed     = pl_data->css_max_speed;
+        block->css_x_end         = target[X_AXIS] - pl_data->css_x_origin;
+        block->css_x_per_mm      = unit_vec[X_AXIS];
+    }
     // Store programmed rate.
     if (block->motion.rapidMotion) {
         block->programmed_rate = block->rapid_rate;
@@ -17,11 +17,14 @@
 #include <cstdint>
 
 // Define planner data condition flags. Used to denote running conditions of a block.
+struct raster_line_t;  // Raster.h
+
 struct PlMotion {
     uint8_t rapidMotion : 1;
     uint8_t systemMotion : 1;    // Single motion. Circumvents planner state. Used by home/park.
     uint8_t noFeedOverride : 1;  // Motion does not honor feed override.
     uint8_t inverseTime : 1;     // Interprets feed rate value as inverse time when set.
+    uint8_t spindleSync : 1;     // Feed follows the spindle encoder (G33, G33.1).
 };
 
 // This struct stores a linear movement of a g-code block motion with its critical "nominal" values
@@ -32,7 +35,7 @@ struct plan_block_t {
 
     uint32_t steps[MAX_N_AXIS];  // Step count along each axis
     uint32_t step_event_count;   // The maximum step axis count and number of steps required to complete this block.
-    uint8_t  direction_bits;     // The direction bit set for this block (refers to *_DIRECTION_BIT in config.h)
+    AxisMask direction_bits;     // The direction bit set for this block, one bit per axis
 
     // Block condition data to ensure correct execution depending on states and overrides.
     PlMotion     motion;       // Block bitflag motion conditions. Copied from pl_line_data.
@@ -57,6 +60,14 @@ struct plan_block_t {
     // Stored spindle speed data used by spindle overrides and resuming methods.
     SpindleSpeed spindle_speed;  // Block spindle speed. Copied from pl_line_data.
 
+    const raster_line_t* raster;  // Per-pixel laser power along the block, or nullptr
+
+    // G96 constant surface speed. The stepper sets the spindle speed from the X radius of each segment.
+    float css_surface_speed;  // Surface speed in mm/min, or 0 if the spindle speed is constant
+    float css_max_speed;      // Spindle speed limit
+    float css_x_end;          // X radius at the end of the block, measured from the spindle axis
+    float css_x_per_mm;       // X component of the direction of travel
+
     bool is_jog;
 };
 
@@ -70,6 +81,12 @@ struct plan_line_data_t {
     int32_t      line_number;     // Desired line number to report when executing.
     bool         is_jog;          // true if this was generated due to a jog command
     bool         limits_checked;  // true if soft limits already checked
+
+    const raster_line_t* raster;  // Per-pixel laser power along the line, or nullptr
+
+    float css_surface_speed;  // G96 surface speed in mm/min, or 0 in G97 mode
+    float css_max_speed;      // G96 spindle speed limit
+    float css_x_origin;       // Machine X position of the spindle axis
 };
 
 void plan_init();
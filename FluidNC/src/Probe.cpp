@@ -6,6 +6,12 @@
 #include "Pin.h"
 #include "Machine/EventPin.h"
 #include "Machine/MachineConfig.h"
+#include "MotionControl.h"  // probing
+#include "Stepper.h"        // Stepper::get_realtime_rate
+#include "Stepping.h"       // Stepping::fStepperTimer
+#include "Driver/delay_usecs.h"
+
+#include <cmath>
 
 extern void protocol_do_probe(void* arg);
 const ArgEvent probeEvent { protocol_do_probe };
@@ -46,11 +52,13 @@ void Probe::init() {
     if (_probePin.defined()) {
         _probeEventPin = new ProbeEventPin("Probe", _probePin);
         _probeEventPin->init();
+        _probeFast = _probePin.capabilities().has(Pin::Capabilities::ISR);
     }
 
     if (_toolsetterPin.defined()) {
         _toolsetterEventPin = new ProbeEventPin("Toolsetter", _toolsetterPin);
         _toolsetterEventPin->init();
+        _toolsetterFast = _toolsetterPin.capabilities().has(Pin::Capabilities::ISR);
     }
 }
 
@@ -68,6 +76,52 @@ bool Probe::tripped() {
     return get_state() ^ _away;
 }
 
+// The polled pin events can lag the trip by a few milliseconds, so at
+// probing feed rates the motors are already well past the contact when
+// protocol_do_probe() sees it.  Reading GPIO pins here costs little and
+// puts the latch within one step tick of the contact.
+bool IRAM_ATTR Probe::latch(uint32_t period) {
+    bool state = (_probeFast && _probePin.read()) || (_toolsetterFast && _toolsetterPin.read());
+    if (!(state ^ _away)) {
+        return false;
+    }
+    auto axes   = config->_axes;
+    auto n_axis = axes->_numberAxis;
+    for (int axis = 0; axis < n_axis; axis++) {
+        auto m            = axes->_axis[axis]->_motors[0];
+        probe_steps[axis] = m ? m->_steps : 0;
+    }
+    _latch_ticks  = getCpuTicks();
+    _latch_period = period;
+    _latched      = true;
+    return true;
+}
+
+bool Probe::take_latch() {
+    if (!_latched) {
+        return false;
+    }
+    _latched = false;
+
+    // The contact happened at most one pin read before the latch
+    float rate  = Stepper::get_realtime_rate();  // mm/min
+    float error = rate / 60.0f * _latch_period / Machine::Stepping::fStepperTimer;
+
+    // How far the motors went before the event arrived; this is the error
+    // that latching in the event would have had.
+    int32_t steps[MAX_N_AXIS];
+    get_motor_steps(steps);
+    auto  axes   = config->_axes;
+    auto  n_axis = axes->_numberAxis;
+    float lag    = 0;
+    for (int axis = 0; axis < n_axis; axis++) {
+        lag = std::max(lag, fabsf(steps_to_mpos(steps[axis] - probe_steps[axis], axis)));
+    }
+    int32_t lag_us = (getCpuTicks() - _latch_ticks) / int32_t(ticks_per_us);
+    log_debug("Probe latch error:" << error << "mm, event lag:" << lag_us << "us " << lag << "mm");
+    return true;
+}
+
 void Probe::validate() {}
 
 void Probe::group(Configuration::HandlerBase& handler) {
@@ -77,10 +131,15 @@ void Probe::group(Configuration::HandlerBase& handler) {
     handler.item("hard_stop", _hard_stop);
 }
 void protocol_do_probe(void* arg) {
-    Probe* p =config->_probe;
-    if (p->tripped() && probing) {
+    Probe* p    = config->_probe;
+    bool   stop = p->take_latch();
+    if (!stop && p->tripped() && probing) {
+        // The stepper ISR could not read the pin
         probing = false;
         get_motor_steps(probe_steps);
+        stop = true;
+    }
+    if (stop) {
         if (p->_hard_stop) {
             Stepper::reset();
             plan_reset();
@@ -7,15 +7,28 @@
 #include "Configuration/HandlerBase.h"
 #include "Configuration/Configurable.h"
 
+#include "Event.h"
+
 #include <cstdint>
 class ProbeEventPin;
 
+extern const ArgEvent probeEvent;
+
 class Probe : public Configuration::Configurable {
     // Inverts the probe pin state depending on user settings and probing cycle mode.
     bool _away = false;
     ProbeEventPin* _probeEventPin;
     ProbeEventPin* _toolsetterEventPin;
 
+    // Set by init() for pins that the stepper ISR can read
+    bool _probeFast      = false;
+    bool _toolsetterFast = false;
+
+    // Set by latch() when the stepper ISR sees the probe trip
+    volatile bool _latched      = false;
+    int32_t       _latch_ticks  = 0;  // CPU ticks at the trip
+    uint32_t      _latch_period = 0;  // Step timer ticks between pin reads at the trip
+
 public:
     bool _hard_stop = false;
     // Configurable
@@ -43,6 +56,15 @@ public:
     // Returns true if the probe pin is tripped, depending on the direction (away or not)
     bool IRAM_ATTR tripped();
 
+    // Called from the stepper ISR while probing, once per step tick.
+    // Reads the pins directly and, if the probe has tripped, records the
+    // motor steps in probe_steps.  Returns true if it did.
+    bool IRAM_ATTR latch(uint32_t period);
+
+    // Called by the probe event.  Returns true, once, if latch() caught
+    // the trip, and reports how accurate the latch was.
+    bool take_latch();
+
     // Configuration handlers.
     void validate() override;
     void group(Configuration::HandlerBase& handler) override;
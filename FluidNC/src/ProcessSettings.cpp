@@ -21,10 +21,15 @@
 #include "FileStream.h"           // FileStream()
 #include "StartupLog.h"           // startupLog
 #include "Driver/fluidnc_gpio.h"  // gpio_dump()
+#include "I2SOut.h"               // i2s_out_get_stats()
 #include "FileCommands.h"         // make_file_commands()
 
 #include "FluidPath.h"
 #include "HashFS.h"
+#include "Raster.h"     // raster_load()
+#include "HeightMap.h"  // probe_grid()
+#include "Motors/TrinamicBase.h"
+#include "Motors/StallGuardCalibration.h"
 
 #include <cstring>
 #include <map>
@@ -476,12 +481,12 @@ static Error home_c(const char* value, AuthenticationLevel auth_level, Channel&
     return home(bitnum_to_mask(C_AXIS), out);
 }
 static std::string limit_set(uint32_t mask) {
-    const char* motor0AxisName = "xyzabc";
+    const char* motor0AxisName = "xyzabcuvw";
     std::string s;
     for (int axis = 0; axis < MAX_N_AXIS; axis++) {
         s += bitnum_is_true(mask, Machine::Axes::motor_bit(axis, 0)) ? char(motor0AxisName[axis]) : ' ';
     }
-    const char* motor1AxisName = "XYZABC";
+    const char* motor1AxisName = "XYZABCUVW";
     for (int axis = 0; axis < MAX_N_AXIS; axis++) {
         s += bitnum_is_true(mask, Machine::Axes::motor_bit(axis, 1)) ? char(motor1AxisName[axis]) : ' ';
     }
@@ -670,6 +675,44 @@ static Error motors_init(const char* value, AuthenticationLevel auth_level, Chan
     return Error::Ok;
 }
 
+static Error motors_status(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    MotorDrivers::TrinamicBase::report_status(out);
+    return Error::Ok;
+}
+
+static bool notIdle() {
+    return !state_is(State::Idle);
+}
+
+static Error motors_calibrate(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    AxisMask axisMask = 0;
+    if (!value || strlen(value) != 1 || !config->_axes->namesToMask(value, axisMask)) {
+        log_error("$Motors/Calibrate requires one axis name, like $MC=X");
+        return Error::InvalidStatement;
+    }
+    auto n_axis = config->_axes->_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        if (bitnum_is_true(axisMask, axis)) {
+            return MotorDrivers::StallGuardCalibration(axis).run();
+        }
+    }
+    return Error::InvalidValue;
+}
+
+static Error probe_grid_cmd(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    return probe_grid(value);
+}
+
+// Raster data is queued along with motion, so it is accepted while
+// a job is running or held as well as when idle.
+static bool notIdleCycleOrHold() {
+    return !state_is(State::Idle) && !state_is(State::Cycle) && !state_is(State::Hold);
+}
+
+static Error raster_data(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    return raster_load(value);
+}
+
 static Error macros_run(const char* value, AuthenticationLevel auth_level, Channel& out) {
     if (value) {
         size_t macro_num = (*value) - '0';
@@ -778,6 +821,21 @@ static Error showHeap(const char* value, AuthenticationLevel auth_level, Channel
     return Error::Ok;
 }
 
+static Error showI2SOStats(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    if (!config->_i2so) {
+        log_error("No i2so section in the config");
+        return Error::InvalidStatement;
+    }
+    i2s_out_stats_t stats;
+    i2s_out_get_stats(stats);
+    LogStream msg(out, MsgLevelInfo, "[MSG:INFO: ");
+    msg << "I2SO underruns:" << stats.underruns << " late buffers:" << stats.late_buffers << " max fill:" << stats.max_fill_us << "us";
+    if (stats.min_slack_us != UINT32_MAX) {
+        msg << " min slack:" << stats.min_slack_us << "us";
+    }
+    return Error::Ok;
+}
+
 // Commands use the same syntax as Settings, but instead of setting or
 // displaying a persistent value, a command causes some action to occur.
 // That action could be anything, from displaying a run-time parameter
@@ -807,6 +865,9 @@ void make_user_commands() {
     new UserCommand("MD", "Motor/Disable", motor_disable, notIdleOrAlarm);
     new UserCommand("ME", "Motor/Enable", motor_enable, notIdleOrAlarm);
     new UserCommand("MI", "Motors/Init", motors_init, notIdleOrAlarm);
+    new UserCommand("MS", "Motors/Status", motors_status, anyState);
+    new UserCommand("MC", "Motors/Calibrate", motors_calibrate, notIdle);
+    new UserCommand("PG", "Probe/Grid", probe_grid_cmd, notIdle);
 
     new UserCommand("RM", "Macros/Run", macros_run, nullptr);
 
@@ -833,6 +894,7 @@ void make_user_commands() {
 
     new UserCommand("SA", "Alarm/Send", sendAlarm, anyState);
     new UserCommand("Heap", "Heap/Show", showHeap, anyState);
+    new UserCommand("I2S", "I2SO/Stats", showI2SOStats, anyState);
     new UserCommand("SS", "Startup/Show", showStartupLog, anyState);
 
     new UserCommand("RI", "Report/Interval", setReportInterval, anyState);
@@ -841,6 +903,7 @@ void make_user_commands() {
     new UserCommand("32", "FakeLaserMode", fakeLaserMode, notIdleOrAlarm);
 
     new AsyncUserCommand("J", "Jog", doJog, notIdleOrJog);
+    new AsyncUserCommand("RD", "Raster/Data", raster_data, notIdleCycleOrHold);
     new AsyncUserCommand("G", "GCode/Modes", report_gcode, anyState);
 };
 
@@ -20,6 +20,7 @@
 #include "SettingsDefinitions.h"  // gcode_echo
 #include "Machine/LimitPin.h"
 #include "Job.h"
+#include "Raster.h"  // raster_reset
 #include "Driver/restart.h"
 
 volatile ExecAlarm lastAlarm;  // The most recent alarm code
@@ -43,6 +44,7 @@ const std::map<ExecAlarm, const char*> AlarmNames = {
     { ExecAlarm::HardStop, "Hard Stop" },
     { ExecAlarm::Unhomed, "Unhomed" },
     { ExecAlarm::Init, "Init" },
+    { ExecAlarm::StepLoss, "Step Loss" },
 };
 
 const char* alarmString(ExecAlarm alarmNumber) {
@@ -402,6 +404,7 @@ static void protocol_do_soft_restart() {
     // possibility of crashing at this point.
 
     plan_reset();  // Clear block buffer and planner variables
+    raster_reset();
 
     if (!state_is(State::ConfigAlarm)) {
         if (spindle) {
@@ -1006,6 +1009,21 @@ static void protocol_do_feed_override(void* incrementvp) {
     }
 }
 
+// Set the Spindles::AdaptiveFeed scale, which multiplies the operator's
+// feed override instead of replacing it.
+static void protocol_do_adaptive_feed(void* percentvp) {
+    int percent = int(percentvp);
+    if (percent > FeedOverride::Max) {
+        percent = FeedOverride::Max;
+    } else if (percent < FeedOverride::Min) {
+        percent = FeedOverride::Min;
+    }
+    if (percent != sys.f_adaptive) {
+        sys.f_adaptive = percent;
+        update_velocities();
+    }
+}
+
 static void protocol_do_rapid_override(void* percentvp) {
     int percent = int(percentvp);
     if (percent != sys.r_override) {
@@ -1036,7 +1054,7 @@ static void protocol_do_spindle_override(void* incrementvp) {
         // If spindle is on, tell it the RPM has been overridden
         // When moving, the override is handled by the stepping code
         if (gc_state.modal.spindle != SpindleState::Disable && !inMotionState()) {
-            spindle->setState(gc_state.modal.spindle, gc_state.spindle_speed);
+            spindle->setState(gc_state.modal.spindle, gc_spindle_rpm());
             gc_ovr_changed();
         }
     }
@@ -1115,6 +1133,7 @@ void protocol_do_rt_reset() {
 }
 
 const ArgEvent feedOverrideEvent { protocol_do_feed_override };
+const ArgEvent adaptiveFeedEvent { protocol_do_adaptive_feed };
 const ArgEvent rapidOverrideEvent { protocol_do_rapid_override };
 const ArgEvent spindleOverrideEvent { protocol_do_spindle_override };
 const ArgEvent accessoryOverrideEvent { protocol_do_accessory_override };
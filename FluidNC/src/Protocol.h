@@ -68,6 +68,7 @@ enum class ExecAlarm : uint8_t {
     HardStop              = 13,
     Unhomed               = 14,
     Init                  = 15,
+    StepLoss              = 16,
 };
 
 extern volatile ExecAlarm lastAlarm;
@@ -85,6 +86,7 @@ enum AccessoryOverride {
 };
 
 extern const ArgEvent feedOverrideEvent;
+extern const ArgEvent adaptiveFeedEvent;
 extern const ArgEvent rapidOverrideEvent;
 extern const ArgEvent spindleOverrideEvent;
 extern const ArgEvent accessoryOverrideEvent;
@@ -0,0 +1,183 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Raster.h"
+
+#include "Machine/MachineConfig.h"
+#include "MotionControl.h"  // mc_linear
+#include "Limits.h"         // limitsMinPosition, limitsMaxPosition
+
+#include <algorithm>
+#include <cmath>
+
+// Scanlines are allocated round-robin from a pool that is larger than the
+// number of motions that can be queued between the parser and the stepper
+// ISR - the planner blocks plus the stepper's block copies - so a line is
+// never reused while a block that refers to it can still be executing.
+static raster_line_t* pool      = nullptr;
+static size_t         pool_size = 0;
+static size_t         pool_next = 0;
+static raster_line_t* pending   = nullptr;
+
+static int base64_value(char c) {
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 26;
+    }
+    if (c >= '0' && c <= '9') {
+        return c - '0' + 52;
+    }
+    if (c == '+') {
+        return 62;
+    }
+    if (c == '/') {
+        return 63;
+    }
+    return -1;
+}
+
+Error raster_load(const char* base64) {
+    if (!spindle->isRateAdjusted()) {
+        log_error("Raster data requires a laser spindle");
+        return Error::InvalidStatement;
+    }
+    if (config->_kinematics->segments_lines()) {
+        // The pixels would only go with the first of the segments
+        log_error("Raster data requires kinematics that plan a G1 as one line");
+        return Error::InvalidStatement;
+    }
+    if (!base64 || !*base64) {
+        return Error::InvalidValue;
+    }
+    if (!pool) {
+        pool_size = config->_planner_blocks + config->_stepping->_segments + 1;
+        pool      = new raster_line_t[pool_size];
+    }
+
+    raster_line_t* line = &pool[pool_next];
+
+    uint32_t bits    = 0;
+    int      n_bits  = 0;
+    uint16_t n_pixel = 0;
+    for (const char* p = base64; *p && *p != '='; ++p) {
+        int value = base64_value(*p);
+        if (value < 0) {
+            log_error("Raster data is not base64");
+            return Error::InvalidValue;
+        }
+        bits = (bits << 6) | value;
+        n_bits += 6;
+        if (n_bits >= 8) {
+            n_bits -= 8;
+            if (n_pixel == RASTER_MAX_PIXELS) {
+                return Error::NumberRange;
+            }
+            line->pixels[n_pixel++] = bits >> n_bits;
+        }
+    }
+    if (n_pixel == 0) {
+        return Error::InvalidValue;
+    }
+    line->n_pixels = n_pixel;
+
+    pending   = line;
+    pool_next = (pool_next + 1) % pool_size;
+    return Error::Ok;
+}
+
+const raster_line_t* raster_take() {
+    auto line = pending;
+    pending   = nullptr;
+    return line;
+}
+
+void raster_reset() {
+    pending = nullptr;
+}
+
+// Shorten an extension of length distance from point along unit_vec so that
+// it stays within the soft limits.
+static float overscan_room(const float* point, const float* unit_vec, float distance) {
+    auto axes   = config->_axes;
+    auto n_axis = axes->_numberAxis;
+    for (int axis = 0; axis < n_axis; axis++) {
+        if (!axes->_axis[axis]->_softLimits || unit_vec[axis] == 0.0f) {
+            continue;
+        }
+        float limit = unit_vec[axis] > 0.0f ? limitsMaxPosition(axis) : limitsMinPosition(axis);
+        float room  = (limit - point[axis]) / unit_vec[axis];
+        if (room < distance) {
+            distance = room > 0.0f ? room : 0.0f;
+        }
+    }
+    return distance;
+}
+
+bool raster_linear(float* target, plan_line_data_t* pl_data, float* position) {
+    if (!spindle->overscan() || pl_data->spindle == SpindleState::Disable) {
+        return mc_linear(target, pl_data, position);
+    }
+
+    auto  n_axis = config->_axes->_numberAxis;
+    float unit_vec[MAX_N_AXIS];
+    for (int axis = 0; axis < n_axis; axis++) {
+        unit_vec[axis] = target[axis] - position[axis];
+    }
+    float millimeters = convert_delta_vector_to_unit_vector(unit_vec);
+    if (millimeters == 0.0f) {
+        return mc_linear(target, pl_data, position);
+    }
+
+    // The distance to reach the nominal speed, as the planner will compute
+    // it for this block, from the feed rate with the override applied.
+    float feed_rate = pl_data->feed_rate;
+    if (pl_data->motion.inverseTime) {
+        feed_rate *= millimeters;
+    }
+    float speed = feed_rate;
+    if (!pl_data->motion.noFeedOverride) {
+        speed *= feed_override_scale();
+    }
+    speed = std::min(speed, limit_rate_by_axis_maximum(unit_vec));
+
+    float distance = speed * speed / (2.0f * limit_acceleration_by_axis_maximum(unit_vec));
+    float reverse[MAX_N_AXIS];
+    for (int axis = 0; axis < n_axis; axis++) {
+        reverse[axis] = -unit_vec[axis];
+    }
+    float lead_in  = overscan_room(position, reverse, distance);
+    float lead_out = overscan_room(target, unit_vec, distance);
+
+    float start[MAX_N_AXIS];
+    float end[MAX_N_AXIS];
+    copyAxes(start, position);
+    copyAxes(end, target);
+    for (int axis = 0; axis < n_axis; axis++) {
+        start[axis] -= unit_vec[axis] * lead_in;
+        end[axis] += unit_vec[axis] * lead_out;
+    }
+
+    // The extensions keep the spindle state, so the laser stays enabled
+    // across the junctions, but run at zero power.
+    plan_line_data_t blank   = *pl_data;
+    blank.raster             = nullptr;
+    blank.spindle_speed      = 0;
+    blank.feed_rate          = feed_rate;
+    blank.motion.inverseTime = 0;
+
+    float here[MAX_N_AXIS];
+    copyAxes(here, position);
+    if (lead_in > 0.0f) {
+        if (!mc_linear(start, &blank, position) || !mc_linear(here, &blank, start)) {
+            return false;
+        }
+    }
+    if (!mc_linear(target, pl_data, here)) {
+        return false;
+    }
+    // The parser position stays at the programmed target.  The next motion
+    // is planned from where the machine actually is, so it starts from the
+    // end of the lead-out.
+    return lead_out == 0.0f || mc_linear(end, &blank, target);
+}
@@ -0,0 +1,47 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+  Raster scanlines for laser engraving.
+
+  $Raster/Data=<base64> holds a run of 8-bit pixel powers, which the next
+  G1 motion consumes.  The pixels are spread evenly along that motion, so
+  the pixel pitch is the length of the move divided by the pixel count,
+  and each pixel's power is S * pixel / 255.  The stepper ISR switches
+  the laser power at pixel boundaries inside one planner block, so an
+  image row costs one command and one G1 instead of one G1 per pixel.
+
+  The motion must reach the planner as a single line, which is the case
+  for Cartesian and CoreXY kinematics.  $Raster/Data is refused with
+  kinematics that split lines into segments.
+*/
+
+#include "Error.h"
+#include "Planner.h"   // plan_line_data_t
+#include "Protocol.h"  // LINE_BUFFER_SIZE
+
+#include <cstdint>
+
+// The most pixels that fit in one line of base64
+const int RASTER_MAX_PIXELS = (LINE_BUFFER_SIZE / 4) * 3;
+
+struct raster_line_t {
+    uint16_t n_pixels;
+    uint8_t  pixels[RASTER_MAX_PIXELS];
+};
+
+// Decode base64 pixel data and hold it for the next G1 motion
+Error raster_load(const char* base64);
+
+// Returns the held scanline, or nullptr, and clears it.  The line stays
+// valid until it has been executed by the stepper.
+const raster_line_t* raster_take();
+
+// Discard a held scanline
+void raster_reset();
+
+// Execute a raster scanline motion.  If the laser has overscan enabled, the
+// line is extended at both ends by the distance needed to reach its feed
+// rate, with the laser blanked over the extensions.
+bool raster_linear(float* target, plan_line_data_t* pl_data, float* position);
@@ -30,6 +30,7 @@
 #include "WebUI/NotificationsService.h"  // WebUI::notificationsService
 #include "InputFile.h"
 #include "Job.h"
+#include "SpindleSync.h"
 
 #include <map>
 #include <freertos/task.h>
@@ -254,6 +255,12 @@ void report_gcode_modes(Channel& channel) {
         case Motion::CcwArc:
             msg << "G3";
             break;
+        case Motion::SpindleSync:
+            msg << "G33";
+            break;
+        case Motion::RigidTap:
+            msg << "G33.1";
+            break;
         case Motion::ProbeToward:
             msg << "G38.2";
             break;
@@ -316,6 +323,11 @@ void report_gcode_modes(Channel& channel) {
             break;
     }
 
+    // G97 is the default, and is not shown to avoid confusing senders that do not know it
+    if (gc_state.modal.spindle_speed_mode == SpindleSpeedMode::SurfaceSpeed) {
+        msg << " G96";
+    }
+
     //report_util_gcode_modes_M();
     switch (gc_state.modal.program_flow) {
         case ProgramFlow::Running:
@@ -544,6 +556,15 @@ void report_realtime_status(Channel& channel) {
     }
     msg << "|FS:" << setprecision(0) << rate << "," << sys.spindle_speed;
 
+    // Report how far the axes trail the spindle during synchronized motion
+    if (SpindleSync::active()) {
+        float error = SpindleSync::phaseError();
+        if (config->_reportInches) {
+            error /= MM_PER_INCH;
+        }
+        msg << "|Sync:" << setprecision(3) << error;
+    }
+
     if (report_pin_string.length()) {
         msg << "|Pn:" << report_pin_string;
     }
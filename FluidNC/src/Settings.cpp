@@ -421,9 +421,12 @@ Error UserCommand::action(const char* value, AuthenticationLevel auth_level, Cha
 Coordinates* coords[CoordIndex::End];
 
 bool Coordinates::load() {
-    size_t len;
+    size_t len = sizeof(_currentValue);
     switch (nvs_get_blob(Setting::_handle, _name, _currentValue, &len)) {
         case ESP_OK:
+            // A value stored with a smaller MAX_N_AXIS has no coordinates
+            // for the added axes, so those start at zero.
+            memset(reinterpret_cast<uint8_t*>(_currentValue) + len, 0, sizeof(_currentValue) - len);
             return true;
         case ESP_ERR_NVS_INVALID_LENGTH:
             // This could happen if the stored value is longer than the buffer.
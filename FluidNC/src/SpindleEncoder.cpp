@@ -0,0 +1,67 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "SpindleEncoder.h"
+
+#include "Machine/MachineConfig.h"
+#include "Driver/pcnt_encoder.h"
+#include "Driver/delay_usecs.h"
+
+#include <cmath>
+
+void SpindleEncoder::init() {
+    if (_simulate) {
+        _sim_ticks = getCpuTicks();
+        _running   = true;
+        log_info("Spindle encoder: simulated " << counts_per_rev() << " counts/rev");
+        return;
+    }
+    if (_a_pin.undefined() || _b_pin.undefined()) {
+        return;
+    }
+    auto a = _a_pin.getNative(Pin::Capabilities::Input | Pin::Capabilities::Native);
+    auto b = _b_pin.getNative(Pin::Capabilities::Input | Pin::Capabilities::Native);
+    if (!pcnt_encoder_init(_pcnt_unit, a, b)) {
+        log_error("Spindle encoder: PCNT unit " << _pcnt_unit << " setup failed");
+        return;
+    }
+    _running = true;
+    log_info("Spindle encoder: A:" << _a_pin.name() << " B:" << _b_pin.name() << " " << counts_per_rev() << " counts/rev");
+}
+
+int32_t SpindleEncoder::count() {
+    if (!_simulate) {
+        return pcnt_encoder_read();
+    }
+    // Integrate the commanded speed since the last call
+    uint32_t now     = getCpuTicks();
+    uint32_t elapsed = now - _sim_ticks;
+    _sim_ticks       = now;
+
+    double rpm = sys.spindle_speed;
+    switch (spindle->get_state()) {
+        case SpindleState::Cw:
+            break;
+        case SpindleState::Ccw:
+            rpm = -rpm;
+            break;
+        default:
+            rpm = 0;
+            break;
+    }
+    _sim_counts += rpm * counts_per_rev() * elapsed / (60e6 * ticks_per_us);
+    return int32_t(floor(_sim_counts));
+}
+
+void SpindleEncoder::validate() {
+    if (_a_pin.defined() != _b_pin.defined()) {
+        log_config_error("Spindle encoder needs both a_pin and b_pin");
+    }
+}
+
+void SpindleEncoder::group(Configuration::HandlerBase& handler) {
+    handler.item("a_pin", _a_pin);
+    handler.item("b_pin", _b_pin);
+    handler.item("pulses_per_rev", _pulses_per_rev, 1, 100000);
+    handler.item("pcnt_unit", _pcnt_unit, 0, 7);
+    handler.item("simulate", _simulate);
+}
@@ -0,0 +1,41 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "Configuration/HandlerBase.h"
+#include "Configuration/Configurable.h"
+
+#include <cstdint>
+
+// Spindle angle feedback for synchronized motion (G33, G33.1).  The
+// encoder is read by the PCNT peripheral, or simulated from the commanded
+// spindle speed when testing without hardware.  Counts must increase when
+// the spindle runs M3; swap a_pin and b_pin if they do not.
+class SpindleEncoder : public Configuration::Configurable {
+    // Simulated encoder state
+    double   _sim_counts = 0;
+    uint32_t _sim_ticks  = 0;
+    bool     _running    = false;
+
+public:
+    SpindleEncoder() = default;
+
+    // Configurable
+    Pin      _a_pin;
+    Pin      _b_pin;
+    uint32_t _pulses_per_rev = 1000;  // Lines per revolution; there are 4 counts per line
+    uint32_t _pcnt_unit      = 0;     // PCNT unit, to keep clear of other PCNT users
+    bool     _simulate       = false;
+
+    bool     exists() const { return _running; }
+    uint32_t counts_per_rev() const { return _pulses_per_rev * 4; }
+
+    void    init();
+    int32_t count();
+
+    // Configuration handlers.
+    void validate() override;
+    void group(Configuration::HandlerBase& handler) override;
+
+    ~SpindleEncoder() = default;
+};
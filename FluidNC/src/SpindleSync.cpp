@@ -0,0 +1,95 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "SpindleSync.h"
+
+#include "SyncTracker.h"
+#include "Machine/MachineConfig.h"
+#include "System.h"
+#include "Protocol.h"  // protocol_execute_realtime
+#include "Driver/delay_usecs.h"
+
+#include <esp32-hal.h>  // micros()
+#include <cmath>
+
+namespace SpindleSync {
+    static volatile bool _active = false;
+    static float         _mm_per_rev;
+    static int           _direction;
+    static int32_t       _origin;
+    static int32_t       _count;
+    static float         _start_mpos[MAX_N_AXIS];
+    static RateEstimator _estimator;
+
+    // Below this the spindle is considered stopped
+    static const float min_rpm = 1.0f;
+
+    static float revolutions() { return float(_count - _origin) * _direction / config->_spindle_encoder->counts_per_rev(); }
+
+    bool start(float mm_per_rev, int direction, bool index) {
+        auto     encoder = config->_spindle_encoder;
+        uint32_t cpr     = encoder->counts_per_rev();
+
+        _mm_per_rev = mm_per_rev;
+        _direction  = direction;
+        _count      = encoder->count();
+        _origin     = _count;
+        _estimator.reset(_count, micros());
+
+        if (index) {
+            delay_ms(50);
+            _count    = encoder->count();
+            float rpm = _estimator.update(_count, micros(), cpr) * direction;
+            if (rpm < min_rpm) {
+                log_error("Spindle sync: spindle is not turning");
+                return false;
+            }
+
+            // The next whole revolution in the direction of rotation
+            int32_t angle = _count * direction;
+            int32_t turns = angle >= 0 ? angle / int32_t(cpr) : -((int32_t(cpr) - 1 - angle) / int32_t(cpr));
+            _origin       = (turns + 1) * int32_t(cpr) * direction;
+
+            uint32_t timeout_ms = uint32_t(2 * 60000 / rpm) + 100;
+            uint32_t start_ms   = millis();
+            while ((_count - _origin) * direction < 0) {
+                // Keep status reports and feed hold alive while waiting
+                protocol_execute_realtime();
+                if (sys.abort) {
+                    return false;
+                }
+                if (millis() - start_ms > timeout_ms) {
+                    log_error("Spindle sync: no index");
+                    return false;
+                }
+                delay_ms(1);
+                _count = encoder->count();
+                _estimator.update(_count, micros(), cpr);
+            }
+        }
+
+        copyAxes(_start_mpos, get_mpos());
+        _active = true;
+        return true;
+    }
+
+    void stop() { _active = false; }
+
+    bool active() { return _active; }
+
+    float follow(float lead, float& speed) {
+        _count = config->_spindle_encoder->count();
+        speed  = _mm_per_rev * _estimator.update(_count, micros(), config->_spindle_encoder->counts_per_rev()) * _direction;
+        return _mm_per_rev * revolutions() + speed * lead;
+    }
+
+    float phaseError() {
+        float* mpos     = get_mpos();
+        float  traveled = 0;
+        auto   n_axis   = config->_axes->_numberAxis;
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            float delta = mpos[axis] - _start_mpos[axis];
+            traveled += delta * delta;
+        }
+        return _mm_per_rev * revolutions() - sqrtf(traveled);
+    }
+}
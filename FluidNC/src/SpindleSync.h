@@ -0,0 +1,25 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// Spindle-synchronized motion.  While active, the segment generator drives
+// the path from the spindle encoder instead of from the planned velocity
+// profile, so the axes advance mm_per_rev for every spindle revolution.
+
+namespace SpindleSync {
+    // Lock the next planned motion to the spindle.  direction is +1 if the
+    // encoder counts up for the commanded rotation, else -1.  With index,
+    // wait for the next whole revolution so that repeated passes, like the
+    // passes of a thread, start at the same spindle angle.  Returns false
+    // if the spindle is not turning in that direction.
+    bool start(float mm_per_rev, int direction, bool index);
+    void stop();
+    bool active();
+
+    // For the segment generator: the path distance the spindle will have
+    // driven lead minutes from now, and the matching speed in mm/min
+    float follow(float lead, float& speed);
+
+    // How far the axes trail the spindle, in mm, for the status report
+    float phaseError();
+}
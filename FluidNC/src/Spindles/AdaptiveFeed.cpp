@@ -0,0 +1,53 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "AdaptiveFeed.h"
+
+#include "../Config.h"    // FeedOverride
+#include "../System.h"    // sys.f_adaptive
+#include "../Protocol.h"  // protocol_send_event
+
+#include <algorithm>
+
+namespace Spindles {
+    bool AdaptiveFeed::active() const {
+        return _target_amps > 0.0f && state_is(State::Cycle);
+    }
+
+    void AdaptiveFeed::update(uint32_t deciamps) {
+        if (!active()) {
+            return;
+        }
+
+        // Positive error means the cutter is lightly loaded and can go faster
+        float error   = (_target_amps - deciamps / 10.0f) / _target_amps;
+        int   percent = sys.f_adaptive;
+        int   delta   = int(percent * _gain * error);
+
+        // Limit each step so one noisy sample cannot slam the feed rate
+        delta       = std::clamp(delta, -FeedOverride::CoarseIncrement, FeedOverride::CoarseIncrement);
+        int next    = std::clamp(percent + delta, int(_min_percent), int(_max_percent));
+        if (next != percent) {
+            protocol_send_event(&adaptiveFeedEvent, next);
+        }
+    }
+
+    // Called on every poll while update() is not; a new job starts at
+    // the operator's override alone.
+    void AdaptiveFeed::finish() {
+        if (!active() && sys.f_adaptive != FeedOverride::Default) {
+            protocol_send_event(&adaptiveFeedEvent, FeedOverride::Default);
+        }
+    }
+
+    void AdaptiveFeed::validate() {
+        Assert(_min_percent <= _max_percent, "adaptive_feed: min_percent must not exceed max_percent");
+    }
+
+    void AdaptiveFeed::group(Configuration::HandlerBase& handler) {
+        handler.item("target_amps", _target_amps, 0.0f, 1000.0f);
+        handler.item("min_percent", _min_percent, FeedOverride::Min, FeedOverride::Max);
+        handler.item("max_percent", _max_percent, FeedOverride::Min, FeedOverride::Max);
+        handler.item("gain", _gain, 0.0f, 1.0f);
+        handler.item("poll_ms", _poll_ms, 20, 1000);
+    }
+}
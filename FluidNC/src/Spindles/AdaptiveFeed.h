@@ -0,0 +1,35 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+#include "../Configuration/Configurable.h"
+
+#include <cstdint>
+
+namespace Spindles {
+    // Scales the feed rate to hold the spindle load near a target.
+    // The owning VFD polls its output current while a job is cutting and
+    // hands each sample to update(), which nudges sys.f_adaptive through
+    // the event queue.  That scale multiplies the operator's feed override,
+    // sys.f_override, which is left alone, and goes back to 100% by
+    // finish() once the cycle is over.
+    class AdaptiveFeed : public Configuration::Configurable {
+    public:
+        AdaptiveFeed() = default;
+
+        float    _target_amps = 0.0f;  // 0 disables
+        uint32_t _min_percent = 50;
+        uint32_t _max_percent = 150;
+        float    _gain        = 0.5f;  // Fraction of the relative load error applied per sample
+        uint32_t _poll_ms     = 100;   // Poll period while cutting; every other poll reads the load
+
+        bool active() const;
+        void update(uint32_t deciamps);
+        void finish();
+
+        void validate() override;
+        void group(Configuration::HandlerBase& handler) override;
+
+        ~AdaptiveFeed() = default;
+    };
+}
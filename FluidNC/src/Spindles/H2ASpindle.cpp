@@ -36,40 +36,25 @@ namespace Spindles {
         //
         // For the H2A VFD, the speed is read directly units of RPM, unlike many
         // other VFDs where it is given in Hz times some scale factor.
-        data.tx_length = 6;
-        data.rx_length = 6;
-
-        uint16_t speed = (uint32_t(dev_speed) * 10000L) / uint32_t(_maxRPM);
-        if (speed < 0) {
-            speed = 0;
-        }
+        uint32_t speed = (uint32_t(dev_speed) * 10000L) / uint32_t(_maxRPM);
         if (speed > 10000) {
             speed = 10000;
         }
 
-        data.msg[1] = 0x06;  // WRITE
-        data.msg[2] = 0x10;  // Command ID 0x1000
-        data.msg[3] = 0x00;
-        data.msg[4] = speed >> 8;
-        data.msg[5] = speed & 0xFF;
+        data.tx_length = 6;
+        data.rx_length = VFDProtocol::H2A::setSpeedRequest(data.msg, speed);
     }
 
     VFD::response_parser H2A::initialization_sequence(int index, ModbusCommand& data) {
         if (index == -1) {
+            // Send: 01 03 B005 0002, B0.05 = Get RPM
             data.tx_length = 6;
-            data.rx_length = 8;
-
-            // Send: 01 03 B005 0002
-            data.msg[1] = 0x03;  // READ
-            data.msg[2] = 0xB0;  // B0.05 = Get RPM
-            data.msg[3] = 0x05;
-            data.msg[4] = 0x00;  // Read 2 values
-            data.msg[5] = 0x02;
+            data.rx_length = VFDProtocol::H2A::readRequest(data.msg, VFDProtocol::H2A::MaxRpmReg);
 
             //  Recv: 01 03 00 04 5D C0 03 F6
             //                    -- -- = 24000 (val #1)
             return [](const uint8_t* response, Spindles::VFD* vfd) -> bool {
-                uint16_t maxRPM = (uint16_t(response[4]) << 8) | uint16_t(response[5]);
+                uint16_t maxRPM = VFDProtocol::H2A::parseValue(response);
 
                 if (vfd->_speeds.size() == 0) {
                     vfd->shelfSpeeds(maxRPM / 4, maxRPM);
@@ -90,20 +75,14 @@ namespace Spindles {
     }
 
     VFD::response_parser H2A::get_current_speed(ModbusCommand& data) {
-        data.tx_length = 6;
-        data.rx_length = 8;
-
         // Send: 01 03 700C 0002
-        data.msg[1] = 0x03;  // READ
-        data.msg[2] = 0x70;  // B0.05 = Get speed
-        data.msg[3] = 0x0C;
-        data.msg[4] = 0x00;  // Read 2 values
-        data.msg[5] = 0x02;
+        data.tx_length = 6;
+        data.rx_length = VFDProtocol::H2A::readRequest(data.msg, VFDProtocol::H2A::SpeedReg);
 
         //  Recv: 01 03 0004 095D 0000
         //                   ---- = 2397 (val #1)
         return [](const uint8_t* response, Spindles::VFD* vfd) -> bool {
-            vfd->_sync_dev_speed = (uint16_t(response[4]) << 8) | uint16_t(response[5]);
+            vfd->_sync_dev_speed = VFDProtocol::H2A::parseValue(response);
             return true;
         };
     }
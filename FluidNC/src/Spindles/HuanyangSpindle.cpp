@@ -145,25 +145,24 @@ namespace Spindles {
     // _baudrate = 19200;
 
     void Huanyang::direction_command(SpindleState mode, ModbusCommand& data) {
-        // NOTE: data length is excluding the CRC16 checksum.
-        data.tx_length = 4;
-        data.rx_length = 4;
-
-        // data.msg[0] is omitted (modbus address is filled in later)
-        data.msg[1] = 0x03;
-        data.msg[2] = 0x01;
+        using namespace VFDProtocol::Huanyang;
 
+        uint8_t command;
         switch (mode) {
             case SpindleState::Cw:
-                data.msg[3] = 0x01;
+                command = RunForward;
                 break;
             case SpindleState::Ccw:
-                data.msg[3] = 0x11;
+                command = RunReverse;
                 break;
             default:  // SpindleState::Disable
-                data.msg[3] = 0x08;
+                command = Stop;
                 break;
         }
+
+        // NOTE: data length is excluding the CRC16 checksum.
+        // data.msg[0] is omitted (modbus address is filled in later)
+        data.tx_length = data.rx_length = controlRequest(data.msg, command);
     }
 
     void IRAM_ATTR Huanyang::set_speed_command(uint32_t dev_speed, ModbusCommand& data) {
@@ -195,35 +194,24 @@ namespace Spindles {
         // The dev_speed argument is precomputed by that code.
 
         // NOTE: data length is excluding the CRC16 checksum.
-        data.tx_length = 5;
-        data.rx_length = 5;
-
         // data.msg[0] is omitted (modbus address is filled in later)
-        data.msg[1] = 0x05;  // Set register command
-        data.msg[2] = 0x02;  // Register PD002 - main frequency in units of 0.01 Hz
-        data.msg[3] = dev_speed >> 8;
-        data.msg[4] = dev_speed & 0xFF;
+        data.tx_length = data.rx_length = VFDProtocol::Huanyang::frequencyRequest(data.msg, dev_speed);
     }
 
     // This gets data from the VFS. It does not set any values
     VFD::response_parser Huanyang::initialization_sequence(int index, ModbusCommand& data) {
-        // NOTE: data length is excluding the CRC16 checksum.
-        data.tx_length = 6;
-        data.rx_length = 6;
+        using namespace VFDProtocol::Huanyang;
 
+        // NOTE: data length is excluding the CRC16 checksum.
         // data.msg[0] is omitted (modbus address is filled in later)
-        data.msg[1] = 0x01;  // Read setting
-        data.msg[2] = 0x03;  // Len
-        //      [3] = set below...
-        data.msg[4] = 0x00;
-        data.msg[5] = 0x00;
+        data.tx_length = data.rx_length = settingRequest(data.msg, 0);  // PD number set below...
 
         switch (index) {
             case -1:
                 data.msg[3] = 5;  // PD005: max frequency the VFD will allow. Normally 400.
 
                 return [](const uint8_t* response, Spindles::VFD* vfd) -> bool {
-                    uint16_t value = (response[4] << 8) | response[5];
+                    uint16_t value = parseValue(response);
 
                     // Set current RPM value? Somewhere?
                     auto huanyang           = static_cast<Huanyang*>(vfd);
@@ -235,7 +223,7 @@ namespace Spindles {
                 data.msg[3] = 11;  // PD011: frequency lower limit. Normally 0.
 
                 return [](const uint8_t* response, Spindles::VFD* vfd) -> bool {
-                    uint16_t value = (response[4] << 8) | response[5];
+                    uint16_t value = parseValue(response);
 
                     // Set current RPM value? Somewhere?
                     auto huanyang           = static_cast<Huanyang*>(vfd);
@@ -253,7 +241,7 @@ namespace Spindles {
                 data.msg[3] = 144;  // PD144: max rated motor revolution at 50Hz => 24000@400Hz = 3000@50HZ
 
                 return [](const uint8_t* response, Spindles::VFD* vfd) -> bool {
-                    uint16_t value = (response[4] << 8) | response[5];
+                    uint16_t value = parseValue(response);
 
                     // Set current RPM value? Somewhere?
                     auto huanyang           = static_cast<Huanyang*>(vfd);
@@ -300,7 +288,7 @@ namespace Spindles {
                 data.msg[3] = 14;  // Accel value displayed is X.X
 
                 return [](const uint8_t* response, Spindles::VFD* vfd) -> bool {
-                    uint16_t value = (response[4] << 8) | response[5];
+                    uint16_t value = parseValue(response);
 
                     auto huanyang = static_cast<Huanyang*>(vfd);
                     log_info(huanyang->name() << " PD014 Accel:" << float(value) / 10.0);
@@ -311,7 +299,7 @@ namespace Spindles {
                 data.msg[3] = 15;  // Decel alue displayed is X.X
 
                 return [](const uint8_t* response, Spindles::VFD* vfd) -> bool {
-                    uint16_t value = (response[4] << 8) | response[5];
+                    uint16_t value = parseValue(response);
 
                     auto huanyang = static_cast<Huanyang*>(vfd);
                     log_info(huanyang->name() << " PD015 Decel:" << float(value) / 10.0);
@@ -349,15 +337,8 @@ namespace Spindles {
 
     VFD::response_parser Huanyang::get_status_ok(ModbusCommand& data) {
         // NOTE: data length is excluding the CRC16 checksum.
-        data.tx_length = 6;
-        data.rx_length = 6;
-
         // data.msg[0] is omitted (modbus address is filled in later)
-        data.msg[1] = 0x04;
-        data.msg[2] = 0x03;
-        data.msg[3] = reg;
-        data.msg[4] = 0x00;
-        data.msg[5] = 0x00;
+        data.tx_length = data.rx_length = VFDProtocol::Huanyang::statusRequest(data.msg, reg);
 
         if (reg < 0x03) {
             reg++;
@@ -368,19 +349,14 @@ namespace Spindles {
     }
 
     VFD::response_parser Huanyang::get_current_speed(ModbusCommand& data) {
-        // NOTE: data length is excluding the CRC16 checksum.
-        data.tx_length = 6;
-        data.rx_length = 6;
+        using namespace VFDProtocol::Huanyang;
 
+        // NOTE: data length is excluding the CRC16 checksum.
         // data.msg[0] is omitted (modbus address is filled in later)
-        data.msg[1] = 0x04;
-        data.msg[2] = 0x03;
-        data.msg[3] = 0x01;  // Output frequency
-        data.msg[4] = 0x00;
-        data.msg[5] = 0x00;
+        data.tx_length = data.rx_length = statusRequest(data.msg, OutputFrequency);
 
         return [](const uint8_t* response, Spindles::VFD* vfd) -> bool {
-            uint16_t frequency = (response[4] << 8) | response[5];
+            uint16_t frequency = VFDProtocol::Huanyang::parseValue(response);
 
             // Store speed for synchronization
             vfd->_sync_dev_speed = frequency;
@@ -388,6 +364,19 @@ namespace Spindles {
         };
     }
 
+    VFD::response_parser Huanyang::get_current_load(ModbusCommand& data) {
+        using namespace VFDProtocol::Huanyang;
+
+        // NOTE: data length is excluding the CRC16 checksum.
+        // data.msg[0] is omitted (modbus address is filled in later)
+        data.tx_length = data.rx_length = statusRequest(data.msg, OutputCurrent);  // Amps * 10
+
+        return [](const uint8_t* response, Spindles::VFD* vfd) -> bool {
+            vfd->_load = VFDProtocol::Huanyang::parseValue(response);
+            return true;
+        };
+    }
+
     // Configuration registration
     namespace {
         SpindleFactory::InstanceBuilder<Huanyang> registration("Huanyang");
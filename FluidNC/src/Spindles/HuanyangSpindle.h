@@ -25,6 +25,7 @@ namespace Spindles {
         response_parser initialization_sequence(int index, ModbusCommand& data) override;
         response_parser get_status_ok(ModbusCommand& data) override;
         response_parser get_current_speed(ModbusCommand& data) override;
+        response_parser get_current_load(ModbusCommand& data) override;
 
     public:
         Huanyang(const char* name) : VFD(name) {}
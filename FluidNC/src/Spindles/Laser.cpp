@@ -11,6 +11,8 @@
 
 #include "../Machine/MachineConfig.h"
 
+#include <cmath>
+
 // ===================================== Laser ==============================================
 
 namespace Spindles {
@@ -18,9 +20,18 @@ namespace Spindles {
         return true;  // can use M4 (CCW) laser mode.
     }
 
+    const EnumItem Laser::powerCurves[] = { { Laser::Linear, "Linear" }, { Laser::Gamma, "Gamma" }, EnumItem(Laser::Linear) };
+
+    float Laser::rateAdjustment(float rate_ratio) {
+        if (_power_curve == Gamma && rate_ratio > 0.0f) {
+            return powf(rate_ratio, _power_gamma);
+        }
+        return rate_ratio;
+    }
+
     void Laser::config_message() {
         log_info(name() << " Ena:" << _enable_pin.name() << " Out:" << _output_pin.name() << " Freq:" << _pwm->frequency()
-                        << "Hz Period:" << _pwm->period() << atc_info());
+                        << "Hz Period:" << _pwm->period() << " Curve:" << powerCurves[_power_curve].name << atc_info());
     }
 
     void Laser::init() {
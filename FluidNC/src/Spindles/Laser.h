@@ -23,20 +23,47 @@ namespace Spindles {
         Laser& operator=(const Laser&) = delete;
         Laser& operator=(Laser&&)      = delete;
 
-        bool isRateAdjusted() override;
-        void config_message() override;
-        void init() override;
-        void set_direction(bool Clockwise) override {};
-        bool use_delay_settings() const override { return false; }
+        bool  isRateAdjusted() override;
+        float rateAdjustment(float rate_ratio) override;
+        bool  overscan() override { return _overscan; }
+        void  config_message() override;
+        void  init() override;
+        void  set_direction(bool Clockwise) override {};
+        bool  use_delay_settings() const override { return false; }
 
         void group(Configuration::HandlerBase& handler) override {
             // pwm_freq is the only item that the PWM class adds to OnOff
             // We cannot call PWM::group() because that would pick up
             // direction_pin, which we do not want in Laser
             handler.item("pwm_hz", _pwm_freq, 1000, 100000);
+            handler.item("power_curve", _power_curve, powerCurves);
+            handler.item("power_gamma", _power_gamma, 0.1f, 5.0f);
+            handler.item("overscan", _overscan);
             OnOff::groupCommon(handler);
         }
 
         ~Laser() {}
+
+    private:
+        enum PowerCurve {
+            Linear = 0,
+            Gamma,
+        };
+        static const EnumItem powerCurves[];
+
+        // In M4 mode, power follows (velocity / programmed_rate) ^ power_gamma
+        // when power_curve is Gamma, so that the slow parts of the ramps, where
+        // the beam dwells longest, can be thinned out more than proportionally.
+        // The curve is evaluated at the ends of each step segment, and the
+        // stepper ISR ramps the power linearly between them, so within a
+        // segment, up to 1/ACCELERATION_TICKS_PER_SECOND long, gamma is
+        // followed piecewise-linearly.
+        int   _power_curve = Linear;
+        float _power_gamma = 1.0f;
+
+        // Run raster scanlines up to speed before the first pixel and
+        // decelerate after the last one, with the laser blanked, so that
+        // the whole image is engraved at constant velocity.
+        bool _overscan = false;
     };
 }
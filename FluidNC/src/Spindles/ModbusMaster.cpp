@@ -0,0 +1,249 @@
+// Copyright (c) 2020 -	Bart Dring
+// Copyright (c) 2020 -	Stefan de Bruijn
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "ModbusMaster.h"
+
+#include "VFDSpindle.h"
+
+#include "src/Machine/MachineConfig.h"
+#include "src/Report.h"  // hex message
+
+#include <atomic>
+#include <string>
+
+const int        MODBUS_QUEUE_SIZE = 10;                                     // number of commands that can be queued up.
+const int        RESPONSE_WAIT_MS  = 1000;                                   // how long to wait for a response
+const TickType_t response_ticks    = RESPONSE_WAIT_MS / portTICK_PERIOD_MS;  // in milliseconds between commands
+
+namespace Spindles {
+    namespace {
+        // ModbusRtu::Link on top of a Uart
+        class UartLink : public ModbusRtu::Link {
+            Uart& _uart;
+
+        public:
+            UartLink(Uart& uart) : _uart(uart) {}
+
+            void flushRx() override { _uart.flushRx(); }
+            void send(const uint8_t* msg, size_t len) override {
+                _uart.write(msg, len);
+                _uart.flushTxTimed(response_ticks);
+            }
+            size_t receive(uint8_t* buf, size_t len, uint32_t timeout_ms) override {
+                return _uart.timedReadBytes(buf, len, timeout_ms / portTICK_PERIOD_MS);
+            }
+            void idle(uint32_t us) override {
+                // delay_ms() can return up to one tick early, so round up and add one.
+                delay_ms(us / 1000 + 1);
+            }
+
+            void rejected(ModbusRtu::Reply reply, const uint8_t* tx, size_t tx_len, const uint8_t* rx, size_t rx_len) override {
+#ifdef DEBUG_VFD
+                hex_msg((uint8_t*)tx, "RS485 Tx: ", tx_len);
+                hex_msg((uint8_t*)rx, "RS485 Rx: ", rx_len);
+
+                switch (reply) {
+                    case ModbusRtu::Reply::NoResponse:
+                        log_info("RS485 No response");
+                        break;
+                    case ModbusRtu::Reply::WrongId:
+                        log_info("RS485 received message from other modbus device");
+                        break;
+                    case ModbusRtu::Reply::BadLength:
+                        log_info("RS485 received message of unexpected length; got:" << int(rx_len));
+                        break;
+                    default:
+                        log_info("RS485 CRC check failed");
+                        break;
+                }
+#endif
+#ifdef DEBUG_TASK_STACK
+                static UBaseType_t uxHighWaterMark = 0;
+                reportTaskStackSize(uxHighWaterMark);
+#endif
+            }
+        };
+    }
+
+    std::vector<ModbusMaster*> ModbusMaster::_masters;
+
+    ModbusMaster::ModbusMaster(Uart* uart) : _uart(uart) {
+        // Modbus RTU frames are separated by at least 3.5 character times of silence.
+        _frame_gap_us = ModbusRtu::frameGapUs(_uart->_baud);
+
+        // FreeRTOS copies the name, so a temporary is fine
+        std::string name("modbus_");
+        name += _uart->name();
+
+        _cmd_queue = xQueueCreate(MODBUS_QUEUE_SIZE, sizeof(Action));
+        xTaskCreatePinnedToCore(task,          // task
+                                name.c_str(),  // name for task
+                                2048,          // size of task stack
+                                this,          // parameters
+                                1,             // priority
+                                &_task_handle,
+                                SUPPORT_TASK_CORE  // core
+        );
+    }
+
+    ModbusMaster* ModbusMaster::get(Uart* uart) {
+        // init can happen many times, we only want to start one task per bus
+        for (auto master : _masters) {
+            if (master->_uart == uart) {
+                return master;
+            }
+        }
+        auto master = new ModbusMaster(uart);
+        _masters.push_back(master);
+        return master;
+    }
+
+    void ModbusMaster::add(VFD* device) {
+        std::lock_guard<std::mutex> lock(_devices_mutex);
+        for (auto d : _devices) {
+            if (d == device) {
+                return;
+            }
+            if (d->_modbus_id == device->_modbus_id) {
+                log_warn(device->name() << " spindle has the same modbus_id as " << d->name());
+            }
+        }
+        _devices.push_back(device);
+    }
+
+    bool ModbusMaster::send(Action action) {
+        action.generation = action.device->_generation;
+        return xQueueSend(_cmd_queue, &action, 0) == pdTRUE;
+    }
+
+    void IRAM_ATTR ModbusMaster::sendFromISR(Action action) {
+        action.generation = action.device->_generation;
+        // Ignore errors because reporting is not safe from an ISR.
+        // Perhaps set a flag instead?
+        xQueueSendFromISR(_cmd_queue, &action, 0);
+    }
+
+    // Taking actions out of the queue and putting them back would race with
+    // senders, and could lose other devices' actions if the queue filled up
+    // meanwhile, so the device's generation moves on instead.
+    void ModbusMaster::discard(VFD* device) {
+        device->_generation = device->_generation + 1;
+    }
+
+    void ModbusMaster::reportParsingErrors(const Command& cmd, uint8_t* rx_message, size_t read_length) {
+#ifdef DEBUG_VFD
+        hex_msg(cmd.msg, "RS485 Tx: ", cmd.tx_length);
+        hex_msg(rx_message, "RS485 Rx: ", read_length);
+#endif
+    }
+    void ModbusMaster::frameGap() {
+        UartLink(*_uart).idle(_frame_gap_us);
+    }
+
+    // Pick the device whose poll is due, round-robin so that one busy device
+    // cannot starve the others.  If none is due, wait is set to the time
+    // until the earliest one is.
+    VFD* ModbusMaster::nextPoll(TickType_t& wait) {
+        std::lock_guard<std::mutex> lock(_devices_mutex);
+
+        TickType_t now = xTaskGetTickCount();
+        wait           = portMAX_DELAY;
+
+        for (size_t i = 0; i < _devices.size(); ++i) {
+            size_t     index   = (_next_device + i) % _devices.size();
+            VFD*       device  = _devices[index];
+            TickType_t elapsed = now - device->_last_poll;
+            TickType_t period  = device->poll_period_ms() / portTICK_PERIOD_MS;
+            if (elapsed >= period) {
+                _next_device = index + 1;
+                return device;
+            }
+            if (period - elapsed < wait) {
+                wait = period - elapsed;
+            }
+        }
+        return nullptr;
+    }
+
+    // The communications task
+    void ModbusMaster::task(void* pvParameters) {
+        ModbusMaster* master = static_cast<ModbusMaster*>(pvParameters);
+
+        for (; true;) {
+            std::atomic_thread_fence(std::memory_order::memory_order_seq_cst);  // read fence for settings
+
+            Command              next_cmd;
+            VFD*                 device = nullptr;
+            VFD::response_parser parser = nullptr;
+
+            Action action;
+            if (xQueueReceive(master->_cmd_queue, &action, 0)) {
+                // Commands go ahead of polls.
+                device = action.device;
+                if (action.generation != device->_generation) {
+                    continue;  // Queued before a discard()
+                }
+                if (!device->prepareAction(action, next_cmd)) {
+                    // prepareAction() can return false if the speed
+                    // change is unnecessary - already at that speed.
+                    // In that case we just discard the command.
+                    continue;  // main loop
+                }
+                next_cmd.critical = action.critical;
+            } else {
+                TickType_t wait;
+                device = master->nextPoll(wait);
+                if (device == nullptr) {
+                    // Nothing is due. Sleep until a poll is due, or until a command arrives.
+                    xQueuePeek(master->_cmd_queue, &action, wait);
+                    continue;  // main loop
+                }
+                device->_last_poll = xTaskGetTickCount();
+                parser             = device->nextPoll(next_cmd);
+
+                // If we have no parser, that means get_status_ok is not implemented (and we have
+                // nothing resting in our queue). Let's fall back on a simple continue.
+                if (parser == nullptr) {
+                    continue;  // main loop
+                }
+                next_cmd.critical = false;
+            }
+
+            master->transact(device, next_cmd, parser);
+            master->frameGap();
+        }
+    }
+
+    void ModbusMaster::transact(VFD* device, Command& next_cmd, VFD::response_parser parser) {
+        uint8_t rx_message[MAX_MSG_SIZE];
+
+        // Fill in the fields that are the same for all protocol variants
+        next_cmd.msg[0] = device->_modbus_id;
+
+        // Grabbed the command. Add the CRC16 checksum:
+        next_cmd.tx_length = ModbusRtu::appendCrc(next_cmd.msg, next_cmd.tx_length);
+        next_cmd.rx_length += 2;
+
+#ifdef DEBUG_VFD_ALL
+        if (parser == nullptr) {
+            hex_msg(next_cmd.msg, "RS485 Tx: ", next_cmd.tx_length);
+        }
+#endif
+
+        UartLink link(*_uart);
+        if (!ModbusRtu::exchange(link, next_cmd.msg, next_cmd.tx_length, rx_message, next_cmd.rx_length, RESPONSE_WAIT_MS, _frame_gap_us)) {
+            device->responseMissing(next_cmd.critical);
+            return;
+        }
+
+        // Success.  Should we parse this?
+        if (parser == nullptr || parser(rx_message, device)) {
+            device->responseOk(parser != nullptr);
+        } else {
+            // Parsing failed
+            reportParsingErrors(next_cmd, rx_message, next_cmd.rx_length);
+            device->responseBad();
+        }
+    }
+}
@@ -0,0 +1,85 @@
+// Copyright (c) 2020 -	Bart Dring
+// Copyright (c) 2020 -	Stefan de Bruijn
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+    Modbus RTU master for an RS485 bus.  There is one master per UART, and
+    its task owns the UART and serves every VFD attached to that bus, so
+    VFDs on different buses run concurrently.  Speed and mode commands from
+    any device are sent ahead of periodic status polls, and polls are
+    scheduled per device instead of sleeping after every transaction.
+    Frame spacing is the Modbus t3.5 silent interval computed from the
+    baud rate.
+*/
+
+#include "../Uart.h"
+#include "ModbusRtu.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace Spindles {
+    class VFD;
+
+    class ModbusMaster {
+    public:
+        static const int MAX_MSG_SIZE = ModbusRtu::MAX_MSG_SIZE;
+
+        enum ActionType : uint8_t { actionSetSpeed, actionSetMode };
+        struct Action {
+            VFD*       device;
+            ActionType action;
+            bool       critical;
+            uint32_t   arg;
+            uint32_t   generation;  // Set by send(); stale after discard()
+        };
+
+        struct Command {
+            bool critical;  // TODO SdB: change into `uint8_t critical : 1;`: We want more flags...
+
+            uint8_t tx_length;
+            uint8_t rx_length;
+            uint8_t msg[MAX_MSG_SIZE];
+        };
+
+        // Returns the master for the uart's bus, starting its task the first time.
+        static ModbusMaster* get(Uart* uart);
+
+        void add(VFD* device);
+
+        bool send(Action action);
+        void sendFromISR(Action action);
+
+        // Drop the actions already queued for one device.  The queue is left
+        // alone; the task skips them when they come up.
+        void discard(VFD* device);
+
+    private:
+        ModbusMaster(Uart* uart);
+
+        static std::vector<ModbusMaster*> _masters;
+
+        Uart*             _uart;
+        QueueHandle_t     _cmd_queue   = nullptr;
+        TaskHandle_t      _task_handle = nullptr;
+        std::vector<VFD*> _devices;
+        std::mutex        _devices_mutex;  // add() runs on other tasks while the bus task polls
+        size_t            _next_device  = 0;
+        uint32_t          _frame_gap_us = 0;  // Modbus t3.5 silent interval
+
+        static void task(void* pvParameters);
+
+        VFD* nextPoll(TickType_t& wait);
+        void transact(VFD* device, Command& cmd, bool (*parser)(const uint8_t* response, VFD* device));
+        void frameGap();
+
+        static void reportParsingErrors(const Command& cmd, uint8_t* rx_message, size_t read_length);
+    };
+}
@@ -0,0 +1,104 @@
+// Copyright (c) 2020 -	Bart Dring
+// Copyright (c) 2020 -	Stefan de Bruijn
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "ModbusRtu.h"
+
+#include <cstring>
+
+namespace Spindles {
+    namespace ModbusRtu {
+        // Calculate the CRC on all of the byte except the last 2
+        // It then added the CRC to those last 2 bytes
+        // full_msg_len This is the length of the message including the 2 crc bytes
+        // Source: https://ctlsys.com/support/how_to_compute_the_modbus_rtu_message_crc/
+        uint16_t crc(const uint8_t* buf, size_t msg_len) {
+            uint16_t crc = 0xFFFF;
+            for (size_t pos = 0; pos < msg_len; pos++) {
+                crc ^= uint16_t(buf[pos]);  // XOR byte into least sig. byte of crc.
+
+                for (int i = 8; i != 0; i--) {  // Loop over each bit
+                    if ((crc & 0x0001) != 0) {  // If the LSB is set
+                        crc >>= 1;              // Shift right and XOR 0xA001
+                        crc ^= 0xA001;
+                    } else {        // Else LSB is not set
+                        crc >>= 1;  // Just shift right
+                    }
+                }
+            }
+
+            return crc;
+        }
+
+        size_t appendCrc(uint8_t* msg, size_t msg_len) {
+            auto crc16     = crc(msg, msg_len);
+            msg[msg_len++] = (crc16 & 0xFF);
+            msg[msg_len++] = (crc16 & 0xFF00) >> 8;
+            return msg_len;
+        }
+
+        uint32_t frameGapUs(uint32_t baud) {
+            // A character is 11 bits.  Above 19200 baud the spec fixes the gap at 1750 us.
+            return baud > 19200 ? 1750 : (35 * 11 * 1000000 / 10) / baud;
+        }
+
+        Reply checkReply(const uint8_t* rx, size_t read_length, size_t expected_length, uint8_t id) {
+            if (read_length == 0) {
+                return Reply::NoResponse;
+            }
+            if (rx[0] != id) {
+                return Reply::WrongId;
+            }
+            if (read_length != expected_length) {
+                return Reply::BadLength;
+            }
+            // Generate crc16 for the response:
+            auto crc16response = crc(rx, expected_length - 2);
+            if (rx[read_length - 1] != (crc16response & 0xFF00) >> 8 || rx[read_length - 2] != (crc16response & 0xFF)) {
+                return Reply::BadCrc;
+            }
+            return Reply::Ok;
+        }
+
+        int exchange(Link& link, const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len, uint32_t timeout_ms, uint32_t gap_us) {
+            uint8_t id = tx[0];
+
+            // Assume for the worst, and retry...
+            for (int attempt = 1; attempt <= MAX_RETRIES; ++attempt) {
+                // Flush the UART and write the data:
+                link.flushRx();
+                link.send(tx, tx_len);
+
+                // Read the response
+                size_t read_length  = 0;
+                size_t current_read = link.receive(rx, rx_len, timeout_ms);
+                read_length += current_read;
+
+                // Apparently some Huanyang report modbus errors in the correct way, and the rest not. Sigh.
+                // Let's just check for the condition, and drop the first byte; the loop below reads
+                // the byte that takes its place at the end.
+                if (read_length > 0 && id != 0 && rx[0] == 0) {
+                    memmove(rx, rx + 1, read_length - 1);
+                    read_length--;
+                }
+
+                while (read_length < rx_len && current_read > 0) {
+                    // Try to read more; we're not there yet...
+                    current_read = link.receive(rx + read_length, rx_len - read_length, timeout_ms);
+                    read_length += current_read;
+                }
+
+                auto reply = checkReply(rx, read_length, rx_len, id);
+                if (reply == Reply::Ok) {
+                    return attempt;
+                }
+                link.rejected(reply, tx, tx_len, rx, read_length);
+
+                // Let the line go idle for a full frame gap so the device
+                // resynchronizes before we retry.
+                link.idle(gap_us);
+            }
+            return 0;
+        }
+    }
+}
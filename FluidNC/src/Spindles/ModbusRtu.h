@@ -0,0 +1,58 @@
+// Copyright (c) 2020 -	Bart Dring
+// Copyright (c) 2020 -	Stefan de Bruijn
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+    Modbus RTU framing and the request/response retry loop, kept free of
+    FreeRTOS and UART driver dependencies so it can be exercised by the
+    native unit tests against a simulated slave.  ModbusMaster supplies a
+    Link that talks to a real Uart.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Spindles {
+    namespace ModbusRtu {
+        const int MAX_MSG_SIZE = 16;  // more than enough for a modbus message
+        const int MAX_RETRIES  = 5;   // otherwise the device is marked 'unresponsive'
+
+        enum class Reply : uint8_t {
+            Ok,
+            NoResponse,
+            WrongId,    // Message from another modbus device
+            BadLength,  // Unexpected length
+            BadCrc,
+        };
+
+        // Byte transport for one RS485 bus
+        class Link {
+        public:
+            virtual void   flushRx()                                              = 0;
+            virtual void   send(const uint8_t* msg, size_t len)                   = 0;
+            virtual size_t receive(uint8_t* buf, size_t len, uint32_t timeout_ms) = 0;
+            virtual void   idle(uint32_t us)                                      = 0;  // Keep the line silent
+
+            // Called for each failed attempt, for diagnostics
+            virtual void rejected(Reply reply, const uint8_t* tx, size_t tx_len, const uint8_t* rx, size_t rx_len) {}
+
+            virtual ~Link() {}
+        };
+
+        uint16_t crc(const uint8_t* buf, size_t msg_len);
+
+        // Append the CRC16 to a message of msg_len bytes, returning the new length
+        size_t appendCrc(uint8_t* msg, size_t msg_len);
+
+        // The t3.5 silent interval that separates frames
+        uint32_t frameGapUs(uint32_t baud);
+
+        Reply checkReply(const uint8_t* rx, size_t read_length, size_t expected_length, uint8_t id);
+
+        // Send tx (with CRC) and read an rx_len byte reply into rx, retrying up to
+        // MAX_RETRIES times.  Returns the number of attempts used, or 0 on failure.
+        int exchange(Link& link, const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len, uint32_t timeout_ms, uint32_t gap_us);
+    }
+}
@@ -60,6 +60,8 @@ namespace Spindles {
         void            stop() { setState(SpindleState::Disable, 0); }
         virtual void    config_message() = 0;
         virtual bool    isRateAdjusted();
+        virtual float   rateAdjustment(float rate_ratio) { return rate_ratio; }  // M4 power fraction at a fraction of the programmed rate
+        virtual bool    overscan() { return false; }                             // Extend raster scanlines by the acceleration distance
         virtual bool    use_delay_settings() const { return true; }
         virtual uint8_t get_current_tool_num() { return _current_tool; }
         virtual bool    tool_change(uint32_t tool_number, bool pre_select, bool set_tool);
@@ -0,0 +1,115 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "VFDProtocol.h"
+
+namespace Spindles {
+    namespace VFDProtocol {
+        uint32_t pollPeriodMs(bool syncing, uint32_t sync_poll_ms, uint32_t run_poll_ms) {
+            return syncing ? sync_poll_ms : run_poll_ms;
+        }
+
+        bool atSpeed(const SpeedReport& report, const SpeedReport& previous, uint32_t target, uint32_t slop, uint32_t predict_ms) {
+            uint32_t minSpeedAllowed = target > slop ? (target - slop) : 0;
+            uint32_t maxSpeedAllowed = target + slop;
+
+            if (report.dev_speed >= minSpeedAllowed && report.dev_speed <= maxSpeedAllowed) {
+                return true;
+            }
+            if (predict_ms == 0 || previous.dev_speed == NoSpeed || report.ms == previous.ms) {
+                return false;
+            }
+
+            // Distance still to go to the edge of the window, and how far we moved since the last report.
+            int64_t remaining = report.dev_speed < minSpeedAllowed ? int64_t(minSpeedAllowed) - report.dev_speed
+                                                                   : int64_t(maxSpeedAllowed) - report.dev_speed;
+            int64_t moved     = int64_t(report.dev_speed) - previous.dev_speed;
+            if (moved == 0 || (remaining > 0) != (moved > 0)) {
+                return false;  // Not ramping toward the target
+            }
+            int64_t elapsed_ms   = int64_t(uint32_t(report.ms - previous.ms));
+            int64_t remaining_ms = remaining * elapsed_ms / moved;
+            return remaining_ms <= int64_t(predict_ms);
+        }
+
+        namespace YL620 {
+            size_t setSpeedRequest(uint8_t* msg, uint16_t dev_speed) {
+                msg[1] = 0x06;  // Write single register
+                msg[2] = FrequencyCommandReg >> 8;
+                msg[3] = FrequencyCommandReg & 0xFF;
+                msg[4] = dev_speed >> 8;
+                msg[5] = dev_speed & 0xFF;
+                return 6;  // Echoed back
+            }
+
+            size_t speedRequest(uint8_t* msg) {
+                msg[1] = 0x03;  // Read holding registers
+                msg[2] = OutputFrequencyReg >> 8;
+                msg[3] = OutputFrequencyReg & 0xFF;
+                msg[4] = 0x00;  // One register
+                msg[5] = 0x01;
+                return 5;
+            }
+
+            uint16_t parseSpeed(const uint8_t* response) { return (uint16_t(response[3]) << 8) | uint16_t(response[4]); }
+        }
+
+        namespace H2A {
+            size_t setSpeedRequest(uint8_t* msg, uint16_t percent100) {
+                msg[1] = 0x06;  // Write single register
+                msg[2] = SpeedCommandReg >> 8;
+                msg[3] = SpeedCommandReg & 0xFF;
+                msg[4] = percent100 >> 8;
+                msg[5] = percent100 & 0xFF;
+                return 6;
+            }
+
+            size_t readRequest(uint8_t* msg, uint16_t reg) {
+                msg[1] = 0x03;  // Read holding registers
+                msg[2] = reg >> 8;
+                msg[3] = reg & 0xFF;
+                msg[4] = 0x00;  // Two registers
+                msg[5] = 0x02;
+                return 8;
+            }
+
+            uint16_t parseValue(const uint8_t* response) { return (uint16_t(response[4]) << 8) | uint16_t(response[5]); }
+        }
+
+        namespace Huanyang {
+            size_t controlRequest(uint8_t* msg, uint8_t command) {
+                msg[1] = WriteControl;
+                msg[2] = 0x01;
+                msg[3] = command;
+                return 4;
+            }
+
+            size_t frequencyRequest(uint8_t* msg, uint16_t dev_speed) {
+                msg[1] = WriteFrequency;
+                msg[2] = 0x02;
+                msg[3] = dev_speed >> 8;
+                msg[4] = dev_speed & 0xFF;
+                return 5;
+            }
+
+            size_t settingRequest(uint8_t* msg, uint8_t pd) {
+                msg[1] = ReadSetting;
+                msg[2] = 0x03;
+                msg[3] = pd;
+                msg[4] = 0x00;
+                msg[5] = 0x00;
+                return 6;
+            }
+
+            size_t statusRequest(uint8_t* msg, uint8_t reg) {
+                msg[1] = ReadStatus;
+                msg[2] = 0x03;
+                msg[3] = reg;
+                msg[4] = 0x00;
+                msg[5] = 0x00;
+                return 6;
+            }
+
+            uint16_t parseValue(const uint8_t* response) { return (uint16_t(response[4]) << 8) | uint16_t(response[5]); }
+        }
+    }
+}
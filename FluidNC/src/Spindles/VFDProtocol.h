@@ -0,0 +1,82 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+    VFD speed synchronization and message layouts, kept free of FreeRTOS and
+    the spindle classes so the native unit tests can run them against the
+    simulated VFD in tests/VFDSimulator.h.  VFD::setState() uses atSpeed()
+    on each speed report while it waits.  The YL620, H2A and Huanyang
+    classes build their speed messages here: YL620 is plain Modbus, and the
+    other two are the bus's odd ones out.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Spindles {
+    namespace VFDProtocol {
+        // A speed reported by the VFD, and when the response was parsed
+        struct SpeedReport {
+            uint32_t dev_speed;
+            uint32_t ms;
+        };
+        const uint32_t NoSpeed = UINT32_MAX;  // dev_speed before the first report
+
+        // Poll period: sync_poll_ms while waiting to reach speed, else run_poll_ms
+        uint32_t pollPeriodMs(bool syncing, uint32_t sync_poll_ms, uint32_t run_poll_ms);
+
+        // Whether a report means the spindle is at speed.  The speed is within
+        // slop of target, or, if predict_ms is non-zero, the ramp rate measured
+        // from the previous report says it will be there within predict_ms.
+        bool atSpeed(const SpeedReport& report, const SpeedReport& previous, uint32_t target, uint32_t slop, uint32_t predict_ms);
+
+        // Yalang YL620: speeds are output frequencies in 0.1 Hz.  The request
+        // functions fill msg[1..5], leaving the id and CRC to the bus, and
+        // return the length of the reply without its CRC.
+        namespace YL620 {
+            const uint16_t FrequencyCommandReg = 0x2001;
+            const uint16_t OutputFrequencyReg  = 0x200B;
+
+            size_t setSpeedRequest(uint8_t* msg, uint16_t dev_speed);
+            size_t speedRequest(uint8_t* msg);
+            uint16_t parseSpeed(const uint8_t* response);  // Recv: 01 03 02 05 DC xx xx = 1500
+        }
+
+        // H2A: the speed is set in 0.01% of the maximum and read in RPM.
+        // Reads are answered with a 16-bit byte count.
+        namespace H2A {
+            const uint16_t SpeedCommandReg = 0x1000;
+            const uint16_t SpeedReg        = 0x700C;
+            const uint16_t MaxRpmReg       = 0xB005;
+
+            size_t setSpeedRequest(uint8_t* msg, uint16_t percent100);
+            size_t readRequest(uint8_t* msg, uint16_t reg);  // Reads two registers
+            uint16_t parseValue(const uint8_t* response);    // Recv: 01 03 00 04 09 5D 00 00 = 2397
+        }
+
+        // Huanyang: not Modbus, though it shares the framing and CRC.  Each
+        // message is a function, a data length and the data, and the reply
+        // has the same layout, so the request functions return the length
+        // of both.  Speeds are frequencies in 0.01 Hz.
+        namespace Huanyang {
+            const uint8_t ReadSetting    = 0x01;  // PDnnn
+            const uint8_t WriteControl   = 0x03;
+            const uint8_t ReadStatus     = 0x04;
+            const uint8_t WriteFrequency = 0x05;
+
+            const uint8_t RunForward = 0x01;  // Control commands
+            const uint8_t Stop       = 0x08;
+            const uint8_t RunReverse = 0x11;
+
+            const uint8_t OutputFrequency = 0x01;  // Status registers
+            const uint8_t OutputCurrent   = 0x02;
+
+            size_t controlRequest(uint8_t* msg, uint8_t command);
+            size_t frequencyRequest(uint8_t* msg, uint16_t dev_speed);
+            size_t settingRequest(uint8_t* msg, uint8_t pd);
+            size_t statusRequest(uint8_t* msg, uint8_t reg);
+            uint16_t parseValue(const uint8_t* response);  // Recv: 01 04 03 01 09 C4 = 2500
+        }
+    }
+}
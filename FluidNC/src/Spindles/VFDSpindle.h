@@ -8,6 +8,9 @@
 #include "../Types.h"
 
 #include "../Uart.h"
+#include "ModbusMaster.h"
+#include "AdaptiveFeed.h"
+#include "VFDProtocol.h"
 
 // #define DEBUG_VFD
 // #define DEBUG_VFD_ALL
@@ -17,8 +20,7 @@ namespace Spindles {
 
     class VFD : public Spindle {
     private:
-        static const int VFD_RS485_MAX_MSG_SIZE = 16;  // more than enough for a modbus message
-        static const int MAX_RETRIES            = 5;   // otherwise the spindle is marked 'unresponsive'
+        friend class ModbusMaster;
 
         void set_mode(SpindleState mode, bool critical);
 
@@ -26,33 +28,34 @@ namespace Spindles {
         uint32_t _last_speed          = 0;
         Percent  _last_override_value = 100;  // no override is 100 percent
 
-        static QueueHandle_t vfd_cmd_queue;
-        static TaskHandle_t  vfd_cmdTaskHandle;
-        static void          vfd_cmd_task(void* pvParameters);
+        ModbusMaster* _bus         = nullptr;
+        QueueHandle_t _speed_queue = nullptr;  // Latest speed report, consumed by setState() while syncing
 
-        static uint16_t ModRTU_CRC(uint8_t* buf, int msg_len);
-        enum VFDactionType : uint8_t { actionSetSpeed, actionSetMode };
-        struct VFDaction {
-            VFDactionType action;
-            bool          critical;
-            uint32_t      arg;
-        };
+        // Poll state, owned by the bus task
+        int        _pollidx      = -1;  // < 0 while running initialization_sequence()
+        bool       _unresponsive = false;
+        bool       _polling_load = false;
+        bool       _load_turn    = false;  // Alternates load polls with the safety polls
+        TickType_t _last_poll    = 0;
 
-    protected:
-        struct ModbusCommand {
-            bool critical;  // TODO SdB: change into `uint8_t critical : 1;`: We want more flags...
+        volatile uint32_t _generation = 0;  // Bumped by ModbusMaster::discard()
+
+        bool adaptiveFeedActive() const;
 
-            uint8_t tx_length;
-            uint8_t rx_length;
-            uint8_t msg[VFD_RS485_MAX_MSG_SIZE];
-        };
+        uint32_t poll_period_ms() const;
+
+    protected:
+        using ModbusCommand = ModbusMaster::Command;
 
     private:
+        bool prepareAction(const ModbusMaster::Action& action, ModbusCommand& data);
         bool prepareSetModeCommand(SpindleState mode, ModbusCommand& data);
         bool prepareSetSpeedCommand(uint32_t speed, ModbusCommand& data);
 
-        static void reportParsingErrors(ModbusCommand cmd, uint8_t* rx_message, size_t read_length);
-        static void reportCmdErrors(ModbusCommand cmd, uint8_t* rx_message, size_t read_length, uint8_t id);
+        // Called by the bus task with the outcome of each transaction
+        void responseOk(bool parsed);
+        void responseBad();
+        void responseMissing(bool critical);
 
     protected:
         // Commands:
@@ -62,9 +65,12 @@ namespace Spindles {
         // Commands that return the status. Returns nullptr if unavailable by this VFD (default):
         using response_parser = bool (*)(const uint8_t* response, VFD* spindle);
 
+        response_parser nextPoll(ModbusCommand& data);
+
         virtual response_parser initialization_sequence(int index, ModbusCommand& data) { return nullptr; }
         virtual response_parser get_current_speed(ModbusCommand& data) { return nullptr; }
         virtual response_parser get_current_direction(ModbusCommand& data) { return nullptr; }
+        virtual response_parser get_current_load(ModbusCommand& data) { return nullptr; }  // Sets _load
         virtual response_parser get_status_ok(ModbusCommand& data) = 0;
         virtual bool            safety_polling() const { return true; }
         bool                    use_delay_settings() const override { return true; }
@@ -93,6 +99,13 @@ namespace Spindles {
         volatile uint32_t _sync_dev_speed;
         SpindleSpeed      _slop;
 
+        volatile uint32_t _load          = 0;  // Output current in units of 0.1 A, from get_current_load()
+        AdaptiveFeed*     _adaptive_feed = nullptr;
+
+        // At-speed detection for VFDs that do not use spinup_ms/spindown_ms
+        uint32_t _sync_poll_ms        = 50;  // RPM poll period while ramping toward a new speed
+        uint32_t _at_speed_predict_ms = 0;   // Release early if the measured ramp will reach speed within this time; 0 disables
+
         // Configuration handlers:
         void validate() override;
         void group(Configuration::HandlerBase& handler) override;
@@ -103,13 +103,7 @@ namespace Spindles {
 #endif
 
         data.tx_length = 6;
-        data.rx_length = 6;
-
-        data.msg[1] = 0x06;
-        data.msg[2] = 0x20;
-        data.msg[3] = 0x01;
-        data.msg[4] = speed >> 8;
-        data.msg[5] = speed & 0xFF;
+        data.rx_length = VFDProtocol::YL620::setSpeedRequest(data.msg, speed);
     }
 
     VFD::response_parser YL620::initialization_sequence(int index, ModbusCommand& data) {
@@ -180,24 +174,12 @@ namespace Spindles {
     }
 
     VFD::response_parser YL620::get_current_speed(ModbusCommand& data) {
-        data.tx_length = 6;
-        data.rx_length = 5;
-
         // Send: 01 03 200B 0001
-        data.msg[1] = 0x03;
-        data.msg[2] = 0x20;
-        data.msg[3] = 0x0B;
-        data.msg[4] = 0x00;
-        data.msg[5] = 0x01;
+        data.tx_length = 6;
+        data.rx_length = VFDProtocol::YL620::speedRequest(data.msg);
 
-        //  Recv: 01 03 02 05 DC xx xx
-        //                 ---- = 1500
         return [](const uint8_t* response, Spindles::VFD* vfd) -> bool {
-            uint16_t freq = (uint16_t(response[3]) << 8) | uint16_t(response[4]);
-
-            auto yl620 = static_cast<YL620*>(vfd);
-
-            vfd->_sync_dev_speed = freq;
+            vfd->_sync_dev_speed = VFDProtocol::YL620::parseSpeed(response);
             return true;
         };
     }
@@ -220,6 +202,25 @@ namespace Spindles {
         return [](const uint8_t* response, Spindles::VFD* vfd) -> bool { return true; };
     }
 
+    VFD::response_parser YL620::get_current_load(ModbusCommand& data) {
+        data.tx_length = 6;
+        data.rx_length = 5;
+
+        // Send: 01 03 200C 0001
+        data.msg[1] = 0x03;
+        data.msg[2] = 0x20;
+        data.msg[3] = 0x0C;
+        data.msg[4] = 0x00;
+        data.msg[5] = 0x01;
+
+        //  Recv: 01 03 02 00 2A xx xx
+        //                 ---- = 4.2 A (units of 0.1 A)
+        return [](const uint8_t* response, Spindles::VFD* vfd) -> bool {
+            vfd->_load = (uint16_t(response[3]) << 8) | uint16_t(response[4]);
+            return true;
+        };
+    }
+
     // Configuration registration
     namespace {
         SpindleFactory::InstanceBuilder<YL620> registration("YL620");
@@ -0,0 +1,26 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "StepTiming.h"
+
+#include <cmath>
+
+namespace StepTiming {
+    uint32_t step_ticks(float minutes_per_step, uint32_t timer_hz) {
+        float ticks = ceilf((float(timer_hz) * 60.0f) * minutes_per_step);
+        if (!(ticks < 4294967296.0f)) {
+            return UINT32_MAX;
+        }
+        return ticks < 1.0f ? 1 : uint32_t(ticks);
+    }
+
+    IsrTiming isr_timing(uint32_t stepTicks, uint32_t threshold, int max_level) {
+        int level;
+        for (level = 0; level < max_level; level++) {
+            if (stepTicks < threshold) {
+                break;
+            }
+            stepTicks >>= 1;
+        }
+        return { stepTicks, uint8_t(level) };
+    }
+}
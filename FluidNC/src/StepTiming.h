@@ -0,0 +1,74 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+    Step event timing for the segment generator, and the Bresenham tracer
+    that the stepper ISR runs, kept free of the machine configuration so
+    that the native unit tests can check them against the ideal step times.
+
+    The stepping timers take 32-bit periods, so a step event of any useful
+    length fits in one ISR tick.  AMASS, when enabled, still divides slow
+    step events into 2^level ISR ticks so that the Bresenham tracer spreads
+    the steps of the minor axes more evenly, at the cost of more interrupts.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+// The tracer runs in the stepper ISR, so it must not be left out of line in flash
+#define STEP_TIMING_INLINE __attribute__((always_inline)) inline
+
+namespace StepTiming {
+    struct IsrTiming {
+        uint32_t period;       // Timer ticks between ISR ticks
+        uint8_t  amass_level;  // Each step event takes 1 << amass_level ISR ticks
+    };
+
+    // Timer ticks per step event, rounded up, for a step event of
+    // minutes_per_step at timer_hz.  Saturates at the longest 32-bit period.
+    uint32_t step_ticks(float minutes_per_step, uint32_t timer_hz);
+
+    // Split a step event of stepTicks into ISR ticks.  Each AMASS level
+    // halves the period while it is at least threshold, up to max_level;
+    // max_level 0 gives one ISR tick per step event.
+    IsrTiming isr_timing(uint32_t stepTicks, uint32_t threshold, int max_level);
+
+    // Bresenham line tracer for up to max_axes axes.  Block step counts and
+    // the block's step event count are scaled up by 2^maxAmassLevel, and a
+    // segment at an AMASS level shifts the per-axis increments down by that
+    // level, so that each of its step events takes 2^level ISR ticks.
+    template <size_t max_axes>
+    struct Tracer {
+        uint32_t counter[max_axes];  // Counter variables for the bresenham line tracer
+        uint32_t steps[max_axes];    // Per-tick increments for the current segment
+
+        // A new planner block starts each axis half way to its first step
+        STEP_TIMING_INLINE void start_block(uint32_t step_event_count, size_t n_axis) {
+            for (size_t axis = 0; axis < n_axis; axis++) {
+                counter[axis] = step_event_count >> 1;
+            }
+        }
+
+        STEP_TIMING_INLINE void start_segment(const volatile uint32_t* block_steps, uint8_t amass_level, size_t n_axis) {
+            for (size_t axis = 0; axis < n_axis; axis++) {
+                steps[axis] = block_steps[axis] >> amass_level;
+            }
+        }
+
+        // One ISR tick of the first n_axis axes.  Returns the axes that step.
+        // n_axis is a template argument so that the loop unrolls.
+        template <size_t n_axis>
+        STEP_TIMING_INLINE uint32_t trace(uint32_t step_event_count) {
+            uint32_t step_outbits = 0;
+            for (size_t axis = 0; axis < n_axis; axis++) {
+                counter[axis] += steps[axis];
+                if (counter[axis] > step_event_count) {
+                    step_outbits |= 1u << axis;
+                    counter[axis] -= step_event_count;
+                }
+            }
+            return step_outbits;
+        }
+    };
+}
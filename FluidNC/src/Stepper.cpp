@@ -13,8 +13,13 @@
 #include "MotionControl.h"
 #include "Stepping.h"
 #include "StepperPrivate.h"
+#include "StepTiming.h"
 #include "Planner.h"
 #include "Protocol.h"
+#include "Raster.h"
+#include "SpindleSync.h"
+#include "SyncTracker.h"
+#include "Driver/delay_usecs.h"  // getCpuTicks()
 #include <esp_attr.h>  // IRAM_ATTR
 #include <cmath>
 
@@ -31,8 +36,15 @@ static bool awake = false;
 struct st_block_t {
     uint32_t steps[MAX_N_AXIS];
     uint32_t step_event_count;
-    uint8_t  direction_bits;
+    AxisMask direction_bits;
     bool     is_pwm_rate_adjusted;  // Tracks motions that require constant laser power/rate
+
+    // Raster scanline. The laser power steps through the pixels as the block executes.
+    const uint8_t* raster;               // Pixel powers 0-255, or nullptr if not a raster block
+    uint16_t       raster_pixels;        // Number of pixels
+    uint32_t       raster_pixel_events;  // Step events per pixel, scaled like step_event_count
+    uint32_t       raster_dev_off;       // Device speed for a 0 pixel
+    uint32_t       raster_dev_range;     // Device speed span from a 0 pixel to a 255 pixel
 };
 static volatile st_block_t* st_block_buffer = nullptr;
 
@@ -42,11 +54,13 @@ static volatile st_block_t* st_block_buffer = nullptr;
 // the planner, where the remaining planner block steps still can.
 struct segment_t {
     uint16_t     n_step;             // Number of step events to be executed for this segment
-    uint16_t     isrPeriod;          // Time to next ISR tick, in units of timer ticks
+    uint32_t     isrPeriod;          // Time to next ISR tick, in units of timer ticks
     uint8_t      st_block_index;     // Stepper block data index. Uses this information to execute this segment.
     uint8_t      amass_level;        // AMASS level for the ISR to execute this segment
-    uint32_t     spindle_dev_speed;  // Spindle speed scaled to the device
+    uint32_t     spindle_dev_speed;  // Spindle speed scaled to the device, at the start of the segment
     SpindleSpeed spindle_speed;      // Spindle speed in GCode units
+    int32_t      power_increment;    // Laser power change per update, in device units * 2^8. 0 = constant
+    uint16_t     power_interval;     // ISR ticks between laser power updates
 };
 static segment_t* segment_buffer = nullptr;
 
@@ -65,15 +79,18 @@ void Stepper::init() {
 typedef struct {
     // Used by the bresenham line algorithm
 
-    uint32_t counter[MAX_N_AXIS];  // Counter variables for the bresenham line tracer
+    StepTiming::Tracer<MAX_N_AXIS> tracer;
 
-    uint8_t  step_bits;     // Stores out_bits output to complete the step pulse delay
+    AxisMask step_bits;     // Stores out_bits output to complete the step pulse delay
     uint8_t  execute_step;  // Flags step execution for each interrupt.
-    uint8_t  step_outbits;  // The next stepping-bits to be output
-    uint8_t  dir_outbits;
-    uint32_t steps[MAX_N_AXIS];
+    AxisMask step_outbits;  // The next stepping-bits to be output
+    AxisMask dir_outbits;
 
     uint16_t             step_count;        // Steps remaining in line segment motion
+    uint16_t             power_countdown;   // ISR ticks until the next laser power update
+    uint32_t             power;             // Laser power in device units * 2^8
+    uint16_t             raster_pixel;      // Raster pixel being executed
+    uint32_t             raster_events;     // Scaled step events into the current pixel
     uint8_t              exec_block_index;  // Tracks the current st_block index. Change indicates new block.
     volatile st_block_t* exec_block;        // Pointer to the block data for the segment being executed
     volatile segment_t*  exec_segment;      // Pointer to the segment being executed
@@ -118,6 +135,8 @@ typedef struct {
     float        inv_rate;  // Used by PWM laser mode to speed up segment calculations.
     SpindleSpeed current_spindle_speed;
 
+    float sync_length;  // Length of a spindle-synchronized block (mm)
+
 } st_prep_t;
 static st_prep_t prep;
 
@@ -153,6 +172,10 @@ static st_prep_t prep;
    Although the AMASS Levels are in reality arbitrary, where the baseline Bresenham counts can
    be multiplied by any integer value, multiplication by powers of two are simply used to ease
    CPU overhead with bitshift integer operations.
+     AMASS can be turned off with stepping/amass. The timer periods are 32 bits, so slow step
+   events do not need it to fit the timer; without it each step event is one ISR tick, which
+   saves up to seven of every eight interrupts at low step rates, but the non-dominant axes
+   can then only step on the dominant axis's step events.
      This interrupt is simple and dumb by design. All the computational heavy-lifting, as in
    determining accelerations, is performed elsewhere. This interrupt pops pre-computed segments,
    defined as constant velocity over n number of steps, from the step segment buffer and then
@@ -175,6 +198,11 @@ static st_prep_t prep;
 
 */
 
+static uint32_t IRAM_ATTR raster_dev_speed() {
+    auto block = st.exec_block;
+    return block->raster_dev_off + block->raster_dev_range * block->raster[st.raster_pixel] / 255;
+}
+
 // Stepper shutdown
 void IRAM_ATTR Stepper::stop_stepping() {
     config->_axes->unstep();
@@ -185,6 +213,187 @@ void IRAM_ATTR Stepper::stop_stepping() {
 uint32_t Stepper::isr_count;  // for debugging only
 #endif
 
+// If no segment is executing, load the next one from the segment buffer.
+// Returns false, having stopped stepping, if the buffer is empty.
+static bool IRAM_ATTR load_segment() {
+    if (st.exec_segment != NULL) {
+        return true;
+    }
+    auto n_axis = config->_axes->_numberAxis;
+
+    // Anything in the buffer? If so, load and initialize next step segment.
+    if (segment_buffer_head != segment_buffer_tail) {
+        // Initialize new step segment and load number of steps to execute
+        st.exec_segment = &segment_buffer[segment_buffer_tail];
+        // Initialize step segment timing per step and load number of steps to execute.
+        config->_stepping->setTimerPeriod(st.exec_segment->isrPeriod);
+        st.step_count = st.exec_segment->n_step;  // NOTE: Can sometimes be zero when moving slow.
+        // If the new segment starts a new planner block, initialize stepper variables and counters.
+        // NOTE: When the segment data index changes, this indicates a new planner block.
+        if (st.exec_block_index != st.exec_segment->st_block_index) {
+            st.exec_block_index = st.exec_segment->st_block_index;
+            st.exec_block       = &st_block_buffer[st.exec_block_index];
+            // Initialize Bresenham line and distance counters
+            st.tracer.start_block(st.exec_block->step_event_count, n_axis);
+            st.raster_pixel  = 0;
+            st.raster_events = 0;
+        }
+
+        st.dir_outbits = st.exec_block->direction_bits;
+        // Adjust Bresenham axis increment counters according to AMASS level.
+        st.tracer.start_segment(st.exec_block->steps, st.exec_segment->amass_level, n_axis);
+        // Set real-time spindle output as segment is loaded, just prior to the first step.
+        spindle->setSpeedfromISR(st.exec_block->raster ? raster_dev_speed() : st.exec_segment->spindle_dev_speed);
+        st.power           = st.exec_segment->spindle_dev_speed << 8;
+        st.power_countdown = st.exec_segment->power_interval;
+        return true;
+    }
+
+    // Segment buffer empty. Shutdown.
+    stop_stepping();
+    if (!state_is(State::Jog)) {  // added to prevent ... jog after probing crash
+        // Ensure pwm is set properly upon completion of rate-controlled motion.
+        if (st.exec_block != NULL && (st.exec_block->is_pwm_rate_adjusted || st.exec_block->raster)) {
+            spindle->setSpeedfromISR(0);
+        }
+    }
+
+    protocol_send_event_from_ISR(&cycleStopEvent);
+    awake = false;
+    return false;  // Nothing to do but exit.
+}
+
+// Check the probe and, while homing, the limit switches.  The steps just
+// taken are the last ones before the pins are read, so a latch is within
+// one tick of the contact.
+static void IRAM_ATTR latch_switches() {
+    if (probing && config->_probe->latch(st.exec_segment->isrPeriod)) {
+        probing = false;
+        protocol_send_event_from_ISR(&probeEvent, config->_probe);
+    }
+    // Stop homing motors at their switches
+    if (sys.state == State::Homing) {
+        config->_axes->latch_limits();
+    }
+}
+
+// Execute step displacement profile by Bresenham line algorithm for
+// the first n_axis axes.  It is instantiated for each axis count up to
+// MAX_N_AXIS so that the loop unrolls to the axes the machine has.
+template <size_t n_axis>
+static inline void IRAM_ATTR trace_axes() {
+    st.step_outbits = st.tracer.trace<n_axis>(st.exec_block->step_event_count);
+}
+
+// Pick the trace_axes for the machine's number of axes
+template <size_t n_axis = MAX_N_AXIS>
+static inline void IRAM_ATTR trace_axes(size_t number_axis) {
+    if constexpr (n_axis > 3) {
+        if (number_axis < n_axis) {
+            trace_axes<n_axis - 1>(number_axis);
+            return;
+        }
+    }
+    trace_axes<n_axis>();
+}
+
+// Execute one step event of the current segment, leaving the axes that
+// step in st.step_outbits.  At the end of the segment, st.exec_segment
+// is cleared.
+static void IRAM_ATTR trace_event() {
+    trace_axes(config->_axes->_numberAxis);
+
+    // Ramp the laser power toward the segment's exit velocity
+    if (st.exec_segment->power_increment && --st.power_countdown == 0) {
+        st.power_countdown = st.exec_segment->power_interval;
+        st.power += st.exec_segment->power_increment;
+        spindle->setSpeedfromISR(st.power >> 8);
+    }
+
+    // Step through the raster pixels. Each ISR tick is 2^(maxAmassLevel - amass_level) scaled step events.
+    if (st.exec_block->raster) {
+        st.raster_events += 1 << (maxAmassLevel - st.exec_segment->amass_level);
+        if (st.raster_events >= st.exec_block->raster_pixel_events && st.raster_pixel < st.exec_block->raster_pixels - 1) {
+            st.raster_events -= st.exec_block->raster_pixel_events;
+            st.raster_pixel++;
+            spindle->setSpeedfromISR(raster_dev_speed());
+        }
+    }
+
+    st.step_count--;  // Decrement step events count
+    if (st.step_count == 0) {
+        // Segment is complete. Discard current segment and advance segment indexing.
+        st.exec_segment     = NULL;
+        segment_buffer_tail = segment_buffer_tail >= (config->_stepping->_segments - 1) ? 0 : segment_buffer_tail + 1;
+    }
+}
+
+// The RMT_burst engine traces up to maxBurstEvents step events of the
+// current segment in one interrupt, and each motor's RMT channel sends
+// the pulses at their event times, so the timer interrupts once per burst
+// instead of once per event.  I2S_stream does the same in the I2S task,
+// which writes each event's step samples into the DMA buffer itself.  The Bresenham tracer runs unchanged.  Probing,
+// homing, raster blocks and laser power ramps act on every event, since
+// anything the tracer does happens when the interrupt runs, not at the
+// event's time; so their bursts are one event long, as are those of
+// machines with motors that cannot pace a burst.  So are the bursts of
+// events longer than 16 bits of timer ticks, which the RMT pulse trains
+// cannot space within a memory block.  Bursts are also kept within maxBurstTicks, because
+// their steps are counted before their pulses go out.
+static uint8_t burst_events[MAX_N_AXIS][Machine::Stepping::maxBurstEvents];
+static uint8_t burst_counts[MAX_N_AXIS];
+
+// When the last burst's pulses will all have gone out, in CPU ticks.
+// Only the ISR and reset() write these; burst_pending is cleared when
+// stepping stops, so burst_end_ticks is never old enough to wrap.
+static volatile int32_t burst_end_ticks = 0;
+static volatile bool    burst_pending   = false;
+
+bool Stepper::burst_sending() {
+    return burst_pending && getCpuTicks() - burst_end_ticks < 0;
+}
+
+static bool IRAM_ATTR pulse_burst() {
+    if (!load_segment()) {
+        burst_pending = false;  // The timer period covered the whole burst
+        return false;
+    }
+    latch_switches();
+
+    auto     n_axis = config->_axes->_numberAxis;
+    uint32_t period = st.exec_segment->isrPeriod;
+    uint32_t limit  = std::min(Machine::Stepping::maxBurstEvents, std::max(Machine::Stepping::maxBurstTicks / period, 1u));
+    bool     rmt    = Machine::Stepping::_engine == Machine::Stepping::RMT_BURST;
+    if (probing || sys.state == State::Homing || st.exec_block->raster || st.exec_segment->power_increment || (rmt && period > 0xffff) ||
+        !config->_axes->_paced_bursts) {
+        limit = 1;
+    }
+    for (int axis = 0; axis < n_axis; axis++) {
+        burst_counts[axis] = 0;
+    }
+    uint32_t events = 0;
+    do {
+        trace_event();
+        for (int axis = 0; axis < n_axis; axis++) {
+            if (bitnum_is_true(st.step_outbits, axis)) {
+                burst_events[axis][burst_counts[axis]++] = events;
+            }
+        }
+        ++events;
+    } while (events < limit && st.exec_segment != NULL);
+    st.step_outbits = 0;
+
+    config->_axes->step_burst(st.dir_outbits, burst_events, burst_counts, period);
+    config->_stepping->startBurst(events, period);
+
+    // The last pulse starts within the burst, after the direction delay
+    uint32_t burst_us = events * period / (Machine::Stepping::fStepperTimer / 1000000) + config->_stepping->_directionDelayUsecs +
+                        config->_stepping->_pulseUsecs;
+    burst_end_ticks   = getCpuTicks() + usToCpuTicks(burst_us);
+    burst_pending     = true;
+    return true;
+}
+
 /**
  * This phase of the ISR should ONLY create the pulses for the steppers.
  * This prevents jitter caused by the interval between the start of the
@@ -201,82 +410,18 @@ bool IRAM_ATTR Stepper::pulse_func() {
     if (!awake) {
         return false;
     }
-    auto n_axis = config->_axes->_numberAxis;
+    if (Machine::Stepping::_engine == Machine::Stepping::RMT_BURST || Machine::Stepping::_engine == Machine::Stepping::I2S_STREAM) {
+        return pulse_burst();
+    }
 
     config->_axes->step(st.step_outbits, st.dir_outbits);
 
     // If there is no step segment, attempt to pop one from the stepper buffer
-    if (st.exec_segment == NULL) {
-        // Anything in the buffer? If so, load and initialize next step segment.
-        if (segment_buffer_head != segment_buffer_tail) {
-            // Initialize new step segment and load number of steps to execute
-            st.exec_segment = &segment_buffer[segment_buffer_tail];
-            // Initialize step segment timing per step and load number of steps to execute.
-            config->_stepping->setTimerPeriod(st.exec_segment->isrPeriod);
-            st.step_count = st.exec_segment->n_step;  // NOTE: Can sometimes be zero when moving slow.
-            // If the new segment starts a new planner block, initialize stepper variables and counters.
-            // NOTE: When the segment data index changes, this indicates a new planner block.
-            if (st.exec_block_index != st.exec_segment->st_block_index) {
-                st.exec_block_index = st.exec_segment->st_block_index;
-                st.exec_block       = &st_block_buffer[st.exec_block_index];
-                // Initialize Bresenham line and distance counters
-                for (int axis = 0; axis < n_axis; axis++) {
-                    st.counter[axis] = st.exec_block->step_event_count >> 1;
-                }
-            }
-
-            st.dir_outbits = st.exec_block->direction_bits;
-            // Adjust Bresenham axis increment counters according to AMASS level.
-            for (int axis = 0; axis < n_axis; axis++) {
-                st.steps[axis] = st.exec_block->steps[axis] >> st.exec_segment->amass_level;
-            }
-            // Set real-time spindle output as segment is loaded, just prior to the first step.
-            spindle->setSpeedfromISR(st.exec_segment->spindle_dev_speed);
-        } else {
-            // Segment buffer empty. Shutdown.
-            stop_stepping();
-            if (!state_is(State::Jog)) {  // added to prevent ... jog after probing crash
-                // Ensure pwm is set properly upon completion of rate-controlled motion.
-                if (st.exec_block != NULL && st.exec_block->is_pwm_rate_adjusted) {
-                    spindle->setSpeedfromISR(0);
-                }
-            }
-
-            protocol_send_event_from_ISR(&cycleStopEvent);
-            awake = false;
-            return false;  // Nothing to do but exit.
-        }
-    }
-#if 0
-    // Check probing state.
-    if (probing && config->_probe->tripped()) {
-        probing = false;
-        auto axes  = config->_axes;
-        for (int axis = 0; axis < n_axis; axis++) {
-            auto m            = axes->_axis[axis]->_motors[0];
-            probe_steps[axis] = m ? m->_steps : 0;
-        }
-        protocol_send_event_from_ISR(&motionCancelEvent);
-    }
-#endif
-    // Reset step out bits.
-    st.step_outbits = 0;
-
-    for (int axis = 0; axis < n_axis; axis++) {
-        // Execute step displacement profile by Bresenham line algorithm
-        st.counter[axis] += st.steps[axis];
-        if (st.counter[axis] > st.exec_block->step_event_count) {
-            set_bitnum(st.step_outbits, axis);
-            st.counter[axis] -= st.exec_block->step_event_count;
-        }
-    }
-
-    st.step_count--;  // Decrement step events count
-    if (st.step_count == 0) {
-        // Segment is complete. Discard current segment and advance segment indexing.
-        st.exec_segment     = NULL;
-        segment_buffer_tail = segment_buffer_tail >= (config->_stepping->_segments - 1) ? 0 : segment_buffer_tail + 1;
+    if (!load_segment()) {
+        return false;
     }
+    latch_switches();
+    trace_event();
 
     config->_axes->unstep();
     return true;
@@ -310,6 +455,13 @@ void Stepper::reset() {
 
     go_idle();
 
+    // Pulses already handed to the RMT must not go out after a reset or alarm.
+    // Stepping::reset() has dropped the rest of an I2S_stream burst.
+    if (Machine::Stepping::_engine == Machine::Stepping::RMT_BURST) {
+        config->_axes->stop_bursts();
+    }
+    burst_pending = false;
+
     // Initialize stepper algorithm variables.
     memset(&prep, 0, sizeof(st_prep_t));
     memset(&st, 0, sizeof(stepper_t));
@@ -368,6 +520,16 @@ void Stepper::parking_restore_buffer() {
     pl_block = NULL;  // Set to reload next block.
 }
 
+// G96 constant surface speed: the spindle speed for the X radius at mm_remaining
+// from the end of the block, clamped to the G96 limit.
+static float css_spindle_speed(plan_block_t* block, float mm_remaining) {
+    float circumference = 2.0f * float(M_PI) * fabsf(block->css_x_end - block->css_x_per_mm * mm_remaining);
+    if (circumference * block->css_max_speed <= block->css_surface_speed) {
+        return block->css_max_speed;
+    }
+    return block->css_surface_speed / circumference;
+}
+
 // Increments the step segment buffer block data ring buffer.
 static uint8_t next_block_index(uint8_t block_index) {
     block_index++;
@@ -438,6 +600,7 @@ void Stepper::prep_buffer() {
                 prep.step_per_mm      = prep.steps_remaining / pl_block->millimeters;
                 prep.req_mm_increment = REQ_MM_INCREMENT_SCALAR / prep.step_per_mm;
                 prep.dt_remainder     = 0.0;  // Reset for new segment block
+                prep.sync_length      = pl_block->millimeters;
                 if ((sys.step_control.executeHold) || prep.recalculate_flag.decelOverride) {
                     // New block loaded mid-hold. Override planner block entry speed to enforce deceleration.
                     prep.current_speed                  = prep.exit_speed;
@@ -449,8 +612,19 @@ void Stepper::prep_buffer() {
 
                 // prep.inv_rate is only used if is_pwm_rate_adjusted is true
                 st_prep_block->is_pwm_rate_adjusted = false;  // set default value
-
-                if (spindle->isRateAdjusted()) {
+                st_prep_block->raster               = nullptr;
+
+                if (pl_block->raster && pl_block->spindle != SpindleState::Disable && spindle->isRateAdjusted()) {
+                    // Raster scanline. Power follows the pixels rather than the velocity.
+                    auto     raster  = pl_block->raster;
+                    uint32_t dev_max = spindle->mapSpeed(pl_block->spindle_speed);
+
+                    st_prep_block->raster              = raster->pixels;
+                    st_prep_block->raster_pixels       = raster->n_pixels;
+                    st_prep_block->raster_pixel_events = st_prep_block->step_event_count / raster->n_pixels;
+                    st_prep_block->raster_dev_off      = spindle->offSpeed();
+                    st_prep_block->raster_dev_range    = dev_max > spindle->offSpeed() ? dev_max - spindle->offSpeed() : 0;
+                } else if (spindle->isRateAdjusted()) {
                     if (pl_block->spindle == SpindleState::Ccw) {
                         // Pre-compute inverse programmed rate to speed up PWM updating per step segment.
                         prep.inv_rate                       = 1.0f / pl_block->programmed_rate;
@@ -543,6 +717,13 @@ void Stepper::prep_buffer() {
                 }
             }
 
+            if (pl_block->motion.spindleSync && !sys.step_control.executeHold) {
+                // The spindle encoder sets the pace instead of the velocity profile.
+                // A feed hold still decelerates normally, abandoning the sync.
+                prep.ramp_type   = RAMP_SYNC;
+                prep.mm_complete = 0.0;
+            }
+
             sys.step_control.updateSpindleSpeed = true;  // Force update whenever updating block.
         }
 
@@ -573,6 +754,7 @@ void Stepper::prep_buffer() {
         float speed_var;                                            // Speed worker variable
         float mm_remaining = pl_block->millimeters;                 // New segment distance from end of block.
         float minimum_mm   = mm_remaining - prep.req_mm_increment;  // Guarantee at least one step.
+        float entry_speed  = prep.current_speed;                    // Speed at the start of the segment
 
         if (minimum_mm < 0.0) {
             minimum_mm = 0.0;
@@ -626,6 +808,33 @@ void Stepper::prep_buffer() {
                         mm_remaining = mm_var;
                     }
                     break;
+                case RAMP_SYNC: {
+                    // Aim for where the spindle will be when this segment ends, which is after
+                    // the segments that are already queued have run.
+                    auto  n_segments = config->_stepping->_segments;
+                    auto  queued     = (segment_buffer_head + n_segments - segment_buffer_tail) % n_segments;
+                    float feed_forward;
+                    float target = SpindleSync::follow(queued * DT_SEGMENT + time_var, feed_forward);
+                    float error  = target - (prep.sync_length - mm_remaining + feed_forward * time_var);
+                    speed_var    = SpindleSync::segmentSpeed(feed_forward,
+                                                             error,
+                                                             prep.current_speed,
+                                                             time_var,
+                                                             pl_block->acceleration,
+                                                             mm_remaining,
+                                                             pl_block->rapid_rate,
+                                                             MINIMUM_FEED_RATE);
+
+                    mm_var = 0.5f * (prep.current_speed + speed_var) * time_var;
+                    if (mm_var < mm_remaining) {
+                        mm_remaining -= mm_var;
+                        prep.current_speed = speed_var;
+                    } else {  // End of block
+                        time_var           = 2.0f * mm_remaining / (prep.current_speed + speed_var);
+                        mm_remaining       = 0.0;
+                        prep.current_speed = 0.0;
+                    }
+                } break;
                 default:  // case RAMP_DECEL:
                     // NOTE: mm_var used as a misc worker variable to prevent errors when near zero speed.
                     speed_var = pl_block->acceleration * time_var;  // Used as delta speed (mm/min)
@@ -662,12 +871,22 @@ void Stepper::prep_buffer() {
         /* -----------------------------------------------------------------------------------
           Compute spindle speed PWM output for step segment
         */
-        if (st_prep_block->is_pwm_rate_adjusted || sys.step_control.updateSpindleSpeed) {
+        uint32_t entry_dev_speed = 0;
+        if (pl_block->css_surface_speed > 0.0f && pl_block->spindle != SpindleState::Disable) {
+            // Follow the X position, but only pass on changes of more than CSS_SPEED_HYSTERESIS so
+            // that spindles with slow interfaces, like RS485 VFDs, are not flooded with updates.
+            float speed = css_spindle_speed(pl_block, mm_remaining);
+            if (sys.step_control.updateSpindleSpeed || fabsf(speed - prep.current_spindle_speed) > CSS_SPEED_HYSTERESIS * speed) {
+                prep.current_spindle_speed = speed;
+            }
+            sys.step_control.updateSpindleSpeed = false;
+        } else if (st_prep_block->is_pwm_rate_adjusted || sys.step_control.updateSpindleSpeed) {
             if (pl_block->spindle != SpindleState::Disable) {
                 float speed = pl_block->spindle_speed;
                 // NOTE: Feed and rapid overrides are independent of PWM value and do not alter laser power/rate.
                 if (st_prep_block->is_pwm_rate_adjusted) {
-                    speed *= (prep.current_speed * prep.inv_rate);
+                    entry_dev_speed = spindle->mapSpeed(speed * spindle->rateAdjustment(entry_speed * prep.inv_rate));
+                    speed *= spindle->rateAdjustment(prep.current_speed * prep.inv_rate);
                     // log_debug("RPM " << rpm);
                     // log_debug("Rates CV " << prep.current_speed << " IV " << prep.inv_rate << " RPM " << rpm);
                 }
@@ -683,6 +902,7 @@ void Stepper::prep_buffer() {
         }
         prep_segment->spindle_speed     = prep.current_spindle_speed;
         prep_segment->spindle_dev_speed = spindle->mapSpeed(prep.current_spindle_speed);  // Reload segment PWM value
+        prep_segment->power_increment   = 0;
 
         /* -----------------------------------------------------------------------------------
            Compute segment step rate, steps to execute, and apply necessary rate corrections.
@@ -728,21 +948,31 @@ void Stepper::prep_buffer() {
         // Compute CPU cycles per step for the prepped segment.
         // fStepperTimer is in units of timerTicks/sec, so the dimensional analysis is
         // timerTicks/sec * 60 sec/minute * minutes = timerTicks
-        uint32_t timerTicks = uint32_t(ceilf((Machine::Stepping::fStepperTimer * 60) * inv_rate));  // (timerTicks/step)
-        int      level;
-
-        // Compute step timing and multi-axis smoothing level.
-        for (level = 0; level < maxAmassLevel; level++) {
-            if (timerTicks < amassThreshold) {
-                break;
+        uint32_t timerTicks = StepTiming::step_ticks(inv_rate, Machine::Stepping::fStepperTimer);  // (timerTicks/step)
+
+        // Compute step timing and multi-axis smoothing level.  The timer period is 32 bits,
+        // so without AMASS a slow step event is a single long ISR tick.
+        auto timing               = StepTiming::isr_timing(timerTicks, amassThreshold, config->_stepping->_amass ? maxAmassLevel : 0);
+        prep_segment->amass_level = timing.amass_level;
+        prep_segment->n_step <<= timing.amass_level;
+        prep_segment->isrPeriod = timing.period;
+
+        // In M4 laser mode, start the segment at the power for its entry velocity
+        // and let the ISR ramp it to the exit velocity power, so that power tracks
+        // the actual step rate through accelerations instead of lagging a segment.
+        if (st_prep_block->is_pwm_rate_adjusted && entry_dev_speed != prep_segment->spindle_dev_speed) {
+            uint32_t interval = laserUpdateTicks / prep_segment->isrPeriod;
+            if (interval == 0) {
+                interval = 1;
+            }
+            uint32_t updates = prep_segment->n_step / interval;
+            if (updates) {
+                int32_t delta                   = int32_t(prep_segment->spindle_dev_speed) - int32_t(entry_dev_speed);
+                prep_segment->power_interval    = interval;
+                prep_segment->power_increment   = (int64_t(delta) << 8) / int32_t(updates);
+                prep_segment->spindle_dev_speed = entry_dev_speed;
             }
-            timerTicks >>= 1;
         }
-        prep_segment->amass_level = level;
-        prep_segment->n_step <<= level;
-        // isrPeriod is stored as 16 bits, so limit timerTicks to the
-        // largest value that will fit in a uint16_t.
-        prep_segment->isrPeriod = timerTicks > 0xffff ? 0xffff : timerTicks;
 
         // Segment complete! Increment segment buffer indices, so stepper ISR can immediately execute it.
         auto lastseg        = segment_next_head;
@@ -778,6 +1008,44 @@ void Stepper::prep_buffer() {
     }
 }
 
+// The segment buffer is read without locking.  If the ISR retires a
+// segment meanwhile, the estimate is off by that segment, which does not
+// matter for a position that is replaced on the next servo update.
+void Stepper::predict_motor_steps(int32_t* steps, uint32_t lead_us) {
+    auto n_axis = config->_axes->_numberAxis;
+    get_motor_steps(steps);
+    if (!awake || lead_us == 0) {
+        return;
+    }
+
+    uint64_t budget  = uint64_t(lead_us) * (Machine::Stepping::fStepperTimer / 1000000);  // In step timer ticks
+    uint32_t index   = segment_buffer_tail;
+    bool     current = st.exec_segment != NULL;
+
+    while (budget && index != segment_buffer_head) {
+        auto segment = &segment_buffer[index];
+        auto block   = &st_block_buffer[segment->st_block_index];
+
+        // The executing segment has only step_count events left
+        uint32_t events = current ? st.step_count : segment->n_step;
+        current         = false;
+
+        uint64_t ticks = uint64_t(events) * segment->isrPeriod;
+        if (ticks > budget) {
+            events = budget / segment->isrPeriod;
+            budget = 0;
+        } else {
+            budget -= ticks;
+        }
+
+        for (int axis = 0; axis < n_axis; axis++) {
+            int32_t delta = uint64_t(events) * (block->steps[axis] >> segment->amass_level) / block->step_event_count;
+            steps[axis] += bitnum_is_true(block->direction_bits, axis) ? -delta : delta;
+        }
+        index = index >= (config->_stepping->_segments - 1) ? 0 : index + 1;
+    }
+}
+
 // Called by realtime status reporting to fetch the current speed being executed. This value
 // however is not exactly the current speed, but the speed computed in the last step segment
 // in the segment buffer. It will always be behind by up to the number of segment blocks (-1)
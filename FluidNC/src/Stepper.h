@@ -45,5 +45,13 @@ namespace Stepper {
     // Called by realtime status reporting if realtime rate reporting is enabled in config.h.
     float get_realtime_rate();
 
+    // Estimates the motor positions lead_us into the future from the queued
+    // segments.  Servo motors use it to lead the steppers by their update latency.
+    void predict_motor_steps(int32_t* steps, uint32_t lead_us);
+
+    // True while RMT_burst pulses whose steps are already counted in
+    // Motor::_steps and _pulses are still going out.
+    bool burst_sending();
+
     extern uint32_t isr_count;
 }
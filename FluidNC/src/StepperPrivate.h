@@ -10,6 +10,7 @@ const int   RAMP_ACCEL              = 0;
 const int   RAMP_CRUISE             = 1;
 const int   RAMP_DECEL              = 2;
 const int   RAMP_DECEL_OVERRIDE     = 3;
+const int   RAMP_SYNC               = 4;  // Spindle-synchronized motion
 
 struct PrepFlag {
     uint8_t recalculate : 1;
@@ -21,8 +22,8 @@ struct PrepFlag {
 // Define Adaptive Multi-Axis Step-Smoothing(AMASS) levels and cutoff frequencies. The highest level
 // frequency bin starts at 0Hz and ends at its cutoff frequency. The next lower level frequency bin
 // starts at the next higher cutoff frequency, and so on. The cutoff frequencies for each level must
-// be considered carefully against how much it over-drives the stepper ISR, the accuracy of the 16-bit
-// timer, and the CPU overhead. Level 0 (no AMASS, normal operation) frequency bin starts at the
+// be considered carefully against how much it over-drives the stepper ISR, the timer resolution,
+// and the CPU overhead. Level 0 (no AMASS, normal operation) frequency bin starts at the
 // Level 1 cutoff frequency and up to as fast as the CPU allows (over 30kHz in limited testing).
 // For efficient computation, each cutoff frequency is twice the previous one.
 // NOTE: AMASS cutoff frequency multiplied by ISR overdrive factor must not exceed maximum step frequency.
@@ -31,3 +32,15 @@ struct PrepFlag {
 
 const uint32_t amassThreshold = Machine::Stepping::fStepperTimer / 8000;
 const int      maxAmassLevel  = 3;  // Each level increase doubles the threshold
+// The Bresenham counts are always scaled for maxAmassLevel, so that turning
+// AMASS off with stepping/amass only changes the level chosen per segment.
+
+// In laser M4 mode the power is ramped within each segment rather than being
+// held at the segment's exit velocity until the next one loads.  The stepper
+// ISR updates the PWM no more often than once per laserUpdateTicks, which is
+// 100 us, so short segments at high step rates do not drown in PWM writes.
+const uint32_t laserUpdateTicks = Machine::Stepping::fStepperTimer / 10000;
+
+// In G96 constant surface speed mode, the spindle speed is only changed when
+// it differs from the current speed by more than this fraction.
+const float CSS_SPEED_HYSTERESIS = 0.01f;
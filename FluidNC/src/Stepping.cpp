@@ -14,11 +14,13 @@ namespace Machine {
                                    { Stepping::RMT, "RMT" },
                                    { Stepping::I2S_STATIC, "I2S_static" },
                                    { Stepping::I2S_STREAM, "I2S_stream" },
+                                   { Stepping::RMT_BURST, "RMT_burst" },
                                    EnumItem(Stepping::RMT) };
 
     void Stepping::init() {
         log_info("Stepping:" << stepTypes[_engine].name << " Pulse:" << _pulseUsecs << "us Dsbl Delay:" << _disableDelayUsecs
-                             << "us Dir Delay:" << _directionDelayUsecs << "us Idle Delay:" << _idleMsecs << "ms");
+                             << "us Dir Delay:" << _directionDelayUsecs << "us Idle Delay:" << _idleMsecs << "ms"
+                             << (_amass ? "" : " AMASS:off"));
 
         // Prepare stepping interrupt callbacks.  The one that is actually
         // used is determined by timerStart() and timerStop()
@@ -106,13 +108,24 @@ namespace Machine {
 
     // Called only from Stepper::pulse_func when a new segment is loaded
     // The argument is in units of ticks of the timer that generates ISRs
-    void IRAM_ATTR Stepping::setTimerPeriod(uint16_t timerTicks) {
+    void IRAM_ATTR Stepping::setTimerPeriod(uint32_t timerTicks) {
         if (_engine == I2S_STREAM) {
             // Pulse ISR is called for each tick of alarm_val.
             // The argument to i2s_out_set_pulse_period is in units of microseconds
-            i2s_out_set_pulse_period(((uint32_t)timerTicks) / ticksPerMicrosecond);
+            i2s_out_set_pulse_period(timerTicks / ticksPerMicrosecond);
         } else {
-            stepTimerSetTicks((uint32_t)timerTicks);
+            stepTimerSetTicks(timerTicks);
+        }
+    }
+
+    // Called only from Stepper::pulse_func once a burst's step events are set up.
+    // RMT_burst interrupts again when the burst is over; the I2S task sends
+    // the events one period apart, as set by setTimerPeriod().
+    void IRAM_ATTR Stepping::startBurst(uint32_t events, uint32_t timerTicks) {
+        if (_engine == I2S_STREAM) {
+            i2s_out_start_burst(events, _pulseUsecs);
+        } else {
+            stepTimerSetTicks(events * timerTicks);
         }
     }
 
@@ -140,14 +153,16 @@ namespace Machine {
         handler.item("dir_delay_us", _directionDelayUsecs, 0, 10);
         handler.item("disable_delay_us", _disableDelayUsecs, 0, 1000000);  // max 1 second
         handler.item("segments", _segments, 6, 20);
+        handler.item("amass", _amass);
     }
 
     void Stepping::afterParse() {
         if (_engine == I2S_STREAM || _engine == I2S_STATIC) {
             Assert(config->_i2so, "I2SO bus must be configured for this stepping type");
-            if (_pulseUsecs < I2S_OUT_USEC_PER_PULSE) {
-                log_warn("Increasing stepping/pulse_us to the IS2 minimum value " << I2S_OUT_USEC_PER_PULSE);
-                _pulseUsecs = I2S_OUT_USEC_PER_PULSE;
+            uint32_t sample_us = config->_i2so->_sample_us;
+            if (_pulseUsecs < sample_us) {
+                log_warn("Increasing stepping/pulse_us to the i2so/sample_us value " << sample_us);
+                _pulseUsecs = sample_us;
             }
             if (_engine == I2S_STREAM && _pulseUsecs > I2S_STREAM_MAX_USEC_PER_PULSE) {
                 log_warn("Decreasing stepping/pulse_us to " << I2S_STREAM_MAX_USEC_PER_PULSE << ", the maximum value for I2S_STREAM");
@@ -160,8 +175,9 @@ namespace Machine {
         switch (_engine) {
             case stepper_id_t::I2S_STREAM:
             case stepper_id_t::I2S_STATIC:
-                return i2s_out_max_steps_per_sec;
+                return 1000000 / (2 * config->_i2so->_sample_us);
             case stepper_id_t::RMT:
+            case stepper_id_t::RMT_BURST:
                 return 1000000 / (2 * _pulseUsecs + _directionDelayUsecs);
             case stepper_id_t::TIMED:
             default:
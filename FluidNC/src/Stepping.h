@@ -27,8 +27,20 @@ namespace Machine {
             RMT,
             I2S_STATIC,
             I2S_STREAM,
+            RMT_BURST,
         };
 
+        // Step events in one RMT_burst interrupt or I2S_stream burst.  Each
+        // motor's RMT pulse train takes at most one RMT item per event, and
+        // must fit in its channel's memory block, 48 items on the S3 and 64
+        // on the ESP32, with the end marker.
+        static const uint32_t maxBurstEvents = 46;
+
+        // Longest burst, in timer ticks.  Steps are counted when a burst
+        // starts, so this bounds how far the reported position and the
+        // pulse counts that step_check samples run ahead of the motors.
+        static const uint32_t maxBurstTicks = fStepperTimer / 1000;
+
         Stepping() = default;
 
         // _segments is the number of entries in the step segment buffer between the step execution algorithm
@@ -45,6 +57,10 @@ namespace Machine {
         uint32_t _directionDelayUsecs = 0;
         uint32_t _disableDelayUsecs   = 0;
 
+        // Adaptive Multi-Axis Step Smoothing.  All of the engines take
+        // 32-bit timer periods, so it is only needed for smoother minor axes.
+        bool _amass = true;
+
         static int _engine;
 
         // Interfaces to stepping engine
@@ -62,7 +78,8 @@ namespace Machine {
         uint32_t maxPulsesPerSec();
 
         // Timers
-        void        setTimerPeriod(uint16_t timerTicks);
+        void        setTimerPeriod(uint32_t timerTicks);
+        void        startBurst(uint32_t events, uint32_t timerTicks);
         void        startTimer();
         static void stopTimer();
 
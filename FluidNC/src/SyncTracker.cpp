@@ -0,0 +1,46 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "SyncTracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SpindleSync {
+    // Position errors are corrected over this time, in minutes.  Shorter
+    // follows the spindle more tightly but makes the axis chase the
+    // encoder count resolution.
+    static const float correction_time = 0.05f / 60.0f;
+
+    float RateEstimator::update(int32_t count, uint32_t us, uint32_t counts_per_rev) {
+        uint32_t elapsed = us - _us;
+        if (elapsed >= _window_us) {
+            _rpm   = float(count - _count) * 60e6f / (float(elapsed) * counts_per_rev);
+            _count = count;
+            _us    = us;
+        }
+        return _rpm;
+    }
+
+    float segmentSpeed(float feed_forward,
+                       float error_mm,
+                       float speed,
+                       float dt,
+                       float acceleration,
+                       float mm_to_go,
+                       float max_speed,
+                       float min_speed) {
+        float target = std::min(feed_forward + error_mm / correction_time, max_speed);
+
+        float delta = acceleration * dt;
+        target      = std::max(speed - delta, std::min(target, speed + delta));
+
+        // The fastest exit speed v from which the axis can still stop at the
+        // end of the block, after covering (speed + v) / 2 * dt in this segment:
+        // v^2 + a*dt*v + a*dt*speed - 2*a*mm_to_go <= 0
+        float disc = delta * delta + 8.0f * acceleration * mm_to_go - 4.0f * delta * speed;
+        float stop = disc > 0.0f ? 0.5f * (sqrtf(disc) - delta) : 0.0f;
+        target     = std::min(target, stop);
+
+        return std::max(target, min_speed);
+    }
+}
@@ -0,0 +1,56 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+/*
+    Feed control for spindle-synchronized motion (G33 and G33.1), kept free
+    of FreeRTOS and machine configuration so it can be exercised by the
+    native unit tests against a simulated spindle.  SpindleSync feeds it
+    encoder readings and the stepper segment generator asks it how fast
+    each segment should end.
+
+    Speeds are in mm/min, accelerations in mm/min^2 and times in minutes,
+    the same units the segment generator uses.
+*/
+
+#include <cstdint>
+
+namespace SpindleSync {
+    // Spindle speed from successive encoder readings.  Readings closer
+    // together than window_us are ignored so that the count resolution
+    // does not turn into speed noise.
+    class RateEstimator {
+        uint32_t _window_us;
+        int32_t  _count = 0;
+        uint32_t _us    = 0;
+        float    _rpm   = 0.0f;
+
+    public:
+        explicit RateEstimator(uint32_t window_us = 20000) : _window_us(window_us) {}
+
+        void reset(int32_t count, uint32_t us) {
+            _count = count;
+            _us    = us;
+            _rpm   = 0.0f;
+        }
+
+        // Returns the signed speed in revolutions per minute
+        float update(int32_t count, uint32_t us, uint32_t counts_per_rev);
+        float rpm() const { return _rpm; }
+    };
+
+    // The speed at the end of a segment lasting dt that starts at speed.
+    // feed_forward is the axis speed that matches the spindle speed, and
+    // error_mm is how far the axis would trail the spindle at the end of
+    // the segment at that speed.  The result is limited by acceleration,
+    // by the need to stop within mm_to_go, and by max_speed; it never
+    // drops below min_speed so that the block always finishes.
+    float segmentSpeed(float feed_forward,
+                       float error_mm,
+                       float speed,
+                       float dt,
+                       float acceleration,
+                       float mm_to_go,
+                       float max_speed,
+                       float min_speed);
+}
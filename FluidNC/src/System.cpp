@@ -26,6 +26,7 @@ void system_reset() {
     set_state(prior_state);
     sys.abort             = prior_abort;
     sys.f_override        = FeedOverride::Default;          // Set to 100%
+    sys.f_adaptive        = FeedOverride::Default;          // Set to 100%
     sys.r_override        = RapidOverride::Default;         // Set to 100%
     sys.spindle_speed_ovr = SpindleSpeedOverride::Default;  // Set to 100%
     memset(probe_steps, 0, sizeof(probe_steps));            // Clear probe position.
@@ -45,6 +45,7 @@ struct system_t {
     Suspend        suspend;            // System suspend bitflag variable that manages holds, cancels, and safety door.
     StepControl    step_control;       // Governs the step segment generator depending on system state.
     Percent        f_override;         // Feed rate override value in percent
+    Percent        f_adaptive;         // Spindles::AdaptiveFeed scale in percent, applied on top of f_override
     Percent        r_override;         // Rapids override value in percent
     Percent        spindle_speed_ovr;  // Spindle speed value in percent
     Override       override_ctrl;      // Tracks override control states.
@@ -52,6 +53,11 @@ struct system_t {
 };
 extern system_t sys;
 
+// The feed rate scale from the operator's override and adaptive feed control
+inline float feed_override_scale() {
+    return 0.0001f * sys.f_override * sys.f_adaptive;
+}
+
 // NOTE: These position variables may need to be declared as volatiles, if problems arise.
 extern int32_t motor_steps[MAX_N_AXIS];  // Real-time machine (aka home) position vector in steps.
 extern int32_t probe_steps[MAX_N_AXIS];  // Last probe position in machine coordinates and steps.
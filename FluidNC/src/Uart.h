@@ -22,7 +22,8 @@ private:
 
     bool setPins(int tx_pin, int rx_pin, int rts_pin = -1, int cts_pin = -1);
 
-    int _uart_num = 0;  // Hardware UART engine number
+    int  _uart_num = 0;  // Hardware UART engine number
+    char _name[6]  = "uartN";
 
 public:
     // These are public so that validators from classes
@@ -40,11 +41,12 @@ public:
     Pin _rts_pin;
     Pin _cts_pin;
 
-    // Name is required for the configuration factory to work.
+    // Name is required for the configuration factory to work.  Each
+    // Uart has its own buffer, so the names of different UARTs can be
+    // held at the same time.
     const char* name() {
-        static char nstr[6] = "uartN";
-        nstr[4]             = _uart_num - '0';
-        return nstr;
+        _name[4] = '0' + _uart_num;
+        return _name;
     }
 
     Uart(int uart_num = -1);
@@ -520,7 +520,7 @@ namespace WebUI {
                 j.member("FlashFileSystem", "LittleFS");
                 j.member("HostPath", "/");
                 j.member("Time", "none");
-                j.member("Axisletters", config->_axes->_names);
+                j.member("Axisletters", std::string(config->_axes->_names, MAX_N_AXIS));
                 j.end_object();
                 j.end();
                 return Error::Ok;
@@ -0,0 +1,98 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/Spindles/ModbusRtu.h"
+#include "VFDSimulator.h"
+
+using namespace Spindles;
+
+static const uint32_t timeout_ms = 1000;
+
+// Build a request in the same layout the VFD classes use, with the CRC appended
+static size_t request(uint8_t* msg, uint8_t id, uint8_t function, uint16_t reg, uint16_t arg) {
+    msg[0] = id;
+    msg[1] = function;
+    msg[2] = reg >> 8;
+    msg[3] = reg & 0xFF;
+    msg[4] = arg >> 8;
+    msg[5] = arg & 0xFF;
+    return ModbusRtu::appendCrc(msg, 6);
+}
+
+static int transact(VFDSimulator& vfd, uint8_t function, uint16_t reg, uint16_t arg, uint8_t* rx, size_t rx_len) {
+    uint8_t tx[ModbusRtu::MAX_MSG_SIZE];
+    size_t  tx_len = request(tx, vfd.id, function, reg, arg);
+    return ModbusRtu::exchange(vfd, tx, tx_len, rx, rx_len, timeout_ms, ModbusRtu::frameGapUs(vfd.baud));
+}
+
+TEST(ModbusRtu, Crc) {
+    // Read one holding register at 0 from slave 1: 01 03 00 00 00 01 84 0A
+    uint8_t msg[ModbusRtu::MAX_MSG_SIZE] = { 0x01, 0x03, 0x00, 0x00, 0x00, 0x01 };
+    ASSERT_EQ(ModbusRtu::appendCrc(msg, 6), 8);
+    ASSERT_EQ(msg[6], 0x84);
+    ASSERT_EQ(msg[7], 0x0A);
+}
+
+TEST(ModbusRtu, FrameGap) {
+    ASSERT_EQ(ModbusRtu::frameGapUs(9600), 4010);
+    ASSERT_EQ(ModbusRtu::frameGapUs(19200), 2005);
+    ASSERT_EQ(ModbusRtu::frameGapUs(115200), 1750);
+}
+
+TEST(ModbusRtu, CheckReply) {
+    uint8_t rx[ModbusRtu::MAX_MSG_SIZE] = { 0x01, 0x06, 0x20, 0x00, 0x12, 0x34 };
+    size_t  len                         = ModbusRtu::appendCrc(rx, 6);
+
+    ASSERT_EQ(ModbusRtu::checkReply(rx, len, len, 1), ModbusRtu::Reply::Ok);
+    ASSERT_EQ(ModbusRtu::checkReply(rx, 0, len, 1), ModbusRtu::Reply::NoResponse);
+    ASSERT_EQ(ModbusRtu::checkReply(rx, len, len, 2), ModbusRtu::Reply::WrongId);
+    ASSERT_EQ(ModbusRtu::checkReply(rx, len - 1, len, 1), ModbusRtu::Reply::BadLength);
+    rx[len - 1] ^= 1;
+    ASSERT_EQ(ModbusRtu::checkReply(rx, len, len, 1), ModbusRtu::Reply::BadCrc);
+}
+
+TEST(ModbusRtu, WriteFirstTry) {
+    VFDSimulator vfd;
+    uint8_t      rx[ModbusRtu::MAX_MSG_SIZE];
+
+    ASSERT_EQ(transact(vfd, 0x06, vfd.setpoint_reg, 12000, rx, 8), 1);
+    ASSERT_EQ(vfd.requests, 1);
+    ASSERT_EQ((rx[4] << 8) | rx[5], 12000);
+}
+
+TEST(ModbusRtu, RetriesCrcFaults) {
+    VFDSimulator vfd;
+    vfd.crc_faults = 2;
+    uint8_t rx[ModbusRtu::MAX_MSG_SIZE];
+
+    ASSERT_EQ(transact(vfd, 0x06, vfd.setpoint_reg, 6000, rx, 8), 3);
+    ASSERT_EQ(vfd.requests, 3);
+}
+
+TEST(ModbusRtu, GivesUpAfterMaxRetries) {
+    VFDSimulator vfd;
+    vfd.always_corrupt_crc = true;
+    uint8_t rx[ModbusRtu::MAX_MSG_SIZE];
+
+    ASSERT_EQ(transact(vfd, 0x06, vfd.setpoint_reg, 6000, rx, 8), 0);
+    ASSERT_EQ(vfd.requests, ModbusRtu::MAX_RETRIES);
+}
+
+TEST(ModbusRtu, NoResponseCostsTimeout) {
+    VFDSimulator vfd;
+    vfd.dropped_responses = 1;
+    uint8_t rx[ModbusRtu::MAX_MSG_SIZE];
+
+    ASSERT_EQ(transact(vfd, 0x06, vfd.setpoint_reg, 6000, rx, 8), 2);
+    ASSERT_GE(vfd.now_us, timeout_ms * 1000ull);
+}
+
+TEST(ModbusRtu, WrongSlaveIsIgnored) {
+    VFDSimulator vfd;
+    vfd.id = 2;
+    uint8_t rx[ModbusRtu::MAX_MSG_SIZE];
+    uint8_t tx[ModbusRtu::MAX_MSG_SIZE];
+    size_t  tx_len = request(tx, 1, 0x06, vfd.setpoint_reg, 6000);
+
+    ASSERT_EQ(ModbusRtu::exchange(vfd, tx, tx_len, rx, 8, timeout_ms, ModbusRtu::frameGapUs(vfd.baud)), 0);
+}
@@ -0,0 +1,144 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/StepTiming.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace StepTiming;
+
+// The stepper's constants, as in StepperPrivate.h
+static const uint32_t fStepperTimer  = 20000000;
+static const uint32_t amassThreshold = fStepperTimer / 8000;
+static const int      maxAmassLevel  = 3;
+
+// Trace a two axis line of major by minor steps at a constant step rate
+// with the stepper ISR's tracer, loading the block and its segment as
+// Stepper.cpp does, and record when each axis steps.
+struct TracedLine {
+    IsrTiming             timing;
+    uint32_t              stepTicks;
+    uint32_t              isr_ticks = 0;
+    uint64_t              end       = 0;  // Timer ticks at the end of the line
+    std::vector<uint64_t> times[2];
+
+    TracedLine(uint32_t major, uint32_t minor, float steps_per_sec, bool amass) {
+        stepTicks = step_ticks(1.0f / (steps_per_sec * 60.0f), fStepperTimer);
+        timing    = isr_timing(stepTicks, amassThreshold, amass ? maxAmassLevel : 0);
+
+        // As the segment generator stores them in st_block_t
+        uint32_t step_event_count = major << maxAmassLevel;
+        uint32_t block_steps[2]   = { major << maxAmassLevel, minor << maxAmassLevel };
+
+        Tracer<2> tracer;
+        tracer.start_block(step_event_count, 2);
+        tracer.start_segment(block_steps, timing.amass_level, 2);
+
+        for (uint32_t tick = 0; tick < (major << timing.amass_level); tick++) {
+            uint32_t step_outbits = tracer.trace<2>(step_event_count);
+            for (int axis = 0; axis < 2; axis++) {
+                if (step_outbits & (1 << axis)) {
+                    times[axis].push_back(end);
+                }
+            }
+            isr_ticks++;
+            end += timing.period;
+        }
+    }
+
+    // Largest distance, in timer ticks, between an axis's steps and the
+    // times at which an exact line crosses the middle of each step.
+    double worst_error(int axis) const {
+        double worst = 0;
+        size_t n     = times[axis].size();
+        for (size_t k = 0; k < n; k++) {
+            double ideal = (k + 0.5) * double(end) / n;
+            worst        = std::max(worst, std::fabs(double(times[axis][k]) - ideal));
+        }
+        return worst;
+    }
+};
+
+TEST(StepTiming, StepTicks) {
+    EXPECT_EQ(step_ticks(1.0f / (1000 * 60.0f), fStepperTimer), 20000u);
+    EXPECT_EQ(step_ticks(1.0f / (0.1f * 60.0f), fStepperTimer), 200000000u);
+    EXPECT_EQ(step_ticks(1000.0f, fStepperTimer), UINT32_MAX);
+    EXPECT_EQ(step_ticks(NAN, fStepperTimer), UINT32_MAX);
+}
+
+TEST(StepTiming, AmassLevels) {
+    EXPECT_EQ(isr_timing(1000, amassThreshold, maxAmassLevel).amass_level, 0);
+    EXPECT_EQ(isr_timing(amassThreshold, amassThreshold, maxAmassLevel).amass_level, 1);
+    EXPECT_EQ(isr_timing(4 * amassThreshold, amassThreshold, maxAmassLevel).amass_level, 3);
+
+    // Without AMASS, a slow step event is one long ISR tick instead of
+    // being cut down to fit 16 bits
+    IsrTiming slow = isr_timing(2000000, amassThreshold, 0);
+    EXPECT_EQ(slow.amass_level, 0);
+    EXPECT_EQ(slow.period, 2000000u);
+}
+
+TEST(StepTiming, MatchesIdealLine) {
+    for (float rate : { 20000.0f, 2000.0f, 200.0f, 10.0f }) {
+        for (bool amass : { true, false }) {
+            TracedLine line(600, 257, rate, amass);
+            SCOPED_TRACE(std::string("rate ") + std::to_string(rate) + (amass ? " amass" : ""));
+
+            // Bresenham is exact whatever the ISR period
+            EXPECT_EQ(line.times[0].size(), 600u);
+            EXPECT_EQ(line.times[1].size(), 257u);
+
+            // The line lasts as long as its step events should, to within
+            // the timer ticks lost dividing each event into ISR ticks
+            double ideal = 600.0 * line.stepTicks;
+            EXPECT_LE(ideal - line.end, 600.0 * ((1 << line.timing.amass_level) - 1));
+            EXPECT_NEAR(line.end / ideal, 1.0, 1e-3);
+
+            // Each step lands within an ISR tick of its ideal time
+            EXPECT_LE(line.worst_error(0), line.timing.period);
+            EXPECT_LE(line.worst_error(1), line.timing.period);
+
+            // AMASS trades interrupts for minor axis smoothness
+            EXPECT_EQ(line.isr_ticks, 600u << line.timing.amass_level);
+        }
+    }
+}
+
+TEST(StepTiming, AmassSmoothsMinorAxis) {
+    TracedLine with(600, 257, 200.0f, true);
+    TracedLine without(600, 257, 200.0f, false);
+
+    EXPECT_EQ(with.timing.amass_level, maxAmassLevel);
+    EXPECT_EQ(without.isr_ticks * 8, with.isr_ticks);
+    EXPECT_LT(with.worst_error(1), without.worst_error(1) / 4);
+}
+
+// A block split into segments at different AMASS levels, as acceleration
+// does, still steps each axis exactly, and only the axes traced step.
+TEST(StepTiming, TracerAcrossSegments) {
+    const uint32_t major = 1000, minor = 333;
+    uint32_t       step_event_count = major << maxAmassLevel;
+    uint32_t       block_steps[3]   = { major << maxAmassLevel, minor << maxAmassLevel, 77u << maxAmassLevel };
+
+    Tracer<3> tracer;
+    tracer.start_block(step_event_count, 3);
+
+    uint32_t       counts[3] = { 0, 0, 0 };
+    const uint32_t events[]  = { 100, 300, 450, 150 };
+    const uint8_t  levels[]  = { 3, 1, 0, 2 };
+    for (int segment = 0; segment < 4; segment++) {
+        tracer.start_segment(block_steps, levels[segment], 3);
+        for (uint32_t tick = 0; tick < (events[segment] << levels[segment]); tick++) {
+            uint32_t step_outbits = tracer.trace<2>(step_event_count);
+            EXPECT_EQ(step_outbits & ~3u, 0u);
+            for (int axis = 0; axis < 2; axis++) {
+                counts[axis] += (step_outbits >> axis) & 1;
+            }
+        }
+    }
+    EXPECT_EQ(counts[0], major);
+    EXPECT_EQ(counts[1], minor);
+}
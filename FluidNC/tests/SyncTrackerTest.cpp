@@ -0,0 +1,99 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/SyncTracker.h"
+
+#include <cmath>
+
+using namespace SpindleSync;
+
+// A spindle with a quadrature encoder, and an axis driven the way the
+// segment generator drives it, both stepped through 10 ms segments.
+struct SyncedAxis {
+    const uint32_t counts_per_rev = 4000;
+    const float    dt             = 0.01f / 60.0f;  // minutes per segment
+    const float    acceleration   = 200.0f * 3600;  // 200 mm/s^2
+    const float    mm_per_rev     = 2.0f;
+    const float    length;
+    const float    max_speed;
+
+    double        spindle_revs = 0;
+    double        rpm;
+    float         position = 0;
+    float         speed    = 0;
+    uint32_t      us       = 0;
+    RateEstimator estimator;
+
+    SyncedAxis(float rpm_, float length_) : length(length_), max_speed(2 * mm_per_rev * rpm_), rpm(rpm_) {
+        estimator.reset(count(), us);
+    }
+
+    int32_t count() const { return int32_t(floor(spindle_revs * counts_per_rev)); }
+
+    // The position the axis should be at, from the encoder
+    float target() const { return mm_per_rev * count() / counts_per_rev; }
+
+    void segment() {
+        float measured = estimator.update(count(), us, counts_per_rev);
+        float ff       = mm_per_rev * measured;
+        float ahead    = mm_per_rev * measured * dt;  // where the spindle will be at the end of the segment
+        float error    = target() + ahead - (position + ff * dt);
+        float next     = segmentSpeed(ff, error, speed, dt, acceleration, length - position, max_speed, 1.0f);
+
+        position += 0.5f * (speed + next) * dt;
+        speed = next;
+        spindle_revs += rpm * dt;
+        us += 10000;
+    }
+
+    float phaseError() const { return target() - position; }
+};
+
+TEST(SpindleSync, RateEstimator) {
+    RateEstimator estimator(20000);
+    estimator.reset(0, 0);
+    ASSERT_EQ(estimator.update(100, 10000, 1000), 0.0f);  // Inside the window
+    ASSERT_FLOAT_EQ(estimator.update(2000, 20000, 1000), 6000.0f);
+    ASSERT_FLOAT_EQ(estimator.update(1000, 40000, 1000), -3000.0f);
+}
+
+TEST(SpindleSync, LocksToSteadySpindle) {
+    SyncedAxis axis(600, 100);
+
+    for (int i = 0; i < 300; ++i) {
+        axis.segment();
+        if (i > 100) {
+            ASSERT_LT(fabsf(axis.phaseError()), 0.01f) << "segment " << i;
+        }
+    }
+}
+
+TEST(SpindleSync, FollowsSpindleUnderLoad) {
+    SyncedAxis axis(600, 100);
+
+    for (int i = 0; i < 400; ++i) {
+        if (i == 150) {
+            axis.rpm = 480;  // 20% slowdown as the tool bites
+        }
+        axis.segment();
+        if (i > 100 && (i < 150 || i > 200)) {
+            ASSERT_LT(fabsf(axis.phaseError()), 0.01f) << "segment " << i;
+        }
+    }
+    ASSERT_NEAR(axis.speed, 2.0f * 480, 1.0f);
+}
+
+TEST(SpindleSync, StopsAtEndOfBlock) {
+    SyncedAxis axis(600, 20);
+    float      max_deceleration = 0;
+
+    while (axis.position < axis.length - 0.001f) {
+        float speed = axis.speed;
+        axis.segment();
+        max_deceleration = std::max(max_deceleration, (speed - axis.speed) / axis.dt);
+        ASSERT_LT(axis.us, 10000000u);
+    }
+    ASSERT_LT(axis.position, axis.length + 0.001f);
+    ASSERT_LE(axis.speed, 1.0f);
+    ASSERT_LE(max_deceleration, axis.acceleration * 1.001f);
+}
@@ -0,0 +1,222 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/Spindles/VFDProtocol.h"
+#include "VFDSimulator.h"
+
+using namespace Spindles;
+namespace YL620    = VFDProtocol::YL620;
+namespace H2A      = VFDProtocol::H2A;
+namespace Huanyang = VFDProtocol::Huanyang;
+
+static const uint32_t timeout_ms  = 1000;
+static const uint32_t run_poll_ms = 250;  // VFD_RS485_POLL_RATE
+
+// A YL620 on the simulated bus
+static void makeYL620(VFDSimulator& vfd) {
+    vfd.setpoint_reg = YL620::FrequencyCommandReg;
+    vfd.speed_reg    = YL620::OutputFrequencyReg;
+}
+
+// A Huanyang, whose frequency command and output frequency are status registers 0 and 1
+static void makeHuanyang(VFDSimulator& vfd) {
+    vfd.protocol     = VFDSimulator::Protocol::Huanyang;
+    vfd.setpoint_reg = VFDSimulator::huanyang_status + 0;
+    vfd.speed_reg    = VFDSimulator::huanyang_status + Huanyang::OutputFrequency;
+}
+
+// Send a request the way ModbusMaster does: id first, then the CRC.
+// Lengths exclude the CRC, as in ModbusMaster::Command.
+static int transact(VFDSimulator& vfd, uint8_t* tx, size_t tx_len, size_t rx_len, uint8_t* rx) {
+    tx[0]  = vfd.id;
+    tx_len = ModbusRtu::appendCrc(tx, tx_len);
+    return ModbusRtu::exchange(vfd, tx, tx_len, rx, rx_len + 2, timeout_ms, ModbusRtu::frameGapUs(vfd.baud));
+}
+
+static uint16_t readSpeed(VFDSimulator& vfd) {
+    uint8_t tx[ModbusRtu::MAX_MSG_SIZE];
+    uint8_t rx[ModbusRtu::MAX_MSG_SIZE];
+    size_t  rx_len = YL620::speedRequest(tx);
+    EXPECT_EQ(transact(vfd, tx, 6, rx_len, rx), 1);
+    return YL620::parseSpeed(rx);
+}
+
+static void setSpeed(VFDSimulator& vfd, uint16_t dev_speed) {
+    uint8_t tx[ModbusRtu::MAX_MSG_SIZE];
+    uint8_t rx[ModbusRtu::MAX_MSG_SIZE];
+    size_t  rx_len = YL620::setSpeedRequest(tx, dev_speed);
+    EXPECT_EQ(transact(vfd, tx, 6, rx_len, rx), 1);
+}
+
+// Huanyang requests and replies have the same length
+static uint16_t huanyang(VFDSimulator& vfd, size_t len, uint8_t* tx, int attempts = 1) {
+    uint8_t rx[ModbusRtu::MAX_MSG_SIZE];
+    EXPECT_EQ(transact(vfd, tx, len, len, rx), attempts);
+    return Huanyang::parseValue(rx);
+}
+
+// Command-to-at-speed latency: set the speed, then poll the output speed
+// as the bus task does while VFD::setState() syncs, until atSpeed() says
+// the spindle is there.
+static uint64_t atSpeedLatencyUs(uint32_t sync_poll_ms, uint32_t predict_ms, uint16_t from = 0) {
+    const uint16_t target = 4000;  // 400.0 Hz
+    const uint16_t slop   = target / 40;
+
+    VFDSimulator vfd;
+    makeYL620(vfd);
+    vfd.ramp_per_s = 2000;  // 2 s from 0 to 400 Hz
+    if (from) {
+        setSpeed(vfd, from);
+        vfd.idle(5000000);
+        EXPECT_EQ(readSpeed(vfd), from);
+    }
+
+    uint64_t start = vfd.now_us;
+    setSpeed(vfd, target);
+
+    VFDProtocol::SpeedReport previous { VFDProtocol::NoSpeed, 0 };
+    while (vfd.now_us - start < 10000000) {
+        VFDProtocol::SpeedReport report { readSpeed(vfd), uint32_t(vfd.now_us / 1000) };
+        if (VFDProtocol::atSpeed(report, previous, target, slop, predict_ms)) {
+            return vfd.now_us - start;
+        }
+        previous = report;
+        vfd.idle(VFDProtocol::pollPeriodMs(true, sync_poll_ms, run_poll_ms) * 1000);
+    }
+    ADD_FAILURE() << "never reached speed";
+    return 0;
+}
+
+static const uint64_t ramp_us        = (4000 - 100) * 1000000ull / 2000;
+static const uint64_t transaction_us = 30000;  // 8 + 7 bytes at 9600 baud plus turnaround
+
+TEST(VFDProtocol, YL620Messages) {
+    VFDSimulator vfd;
+    makeYL620(vfd);
+    vfd.ramp_per_s = 100000;
+
+    setSpeed(vfd, 2500);
+    vfd.idle(100000);
+    EXPECT_EQ(readSpeed(vfd), 2500);
+
+    uint8_t response[] = { 0x01, 0x03, 0x02, 0x05, 0xDC };
+    EXPECT_EQ(YL620::parseSpeed(response), 1500);
+}
+
+TEST(VFDProtocol, H2AMessages) {
+    VFDSimulator vfd;
+    vfd.protocol     = VFDSimulator::Protocol::H2A;
+    vfd.setpoint_reg = H2A::SpeedCommandReg;
+    vfd.speed_reg    = H2A::SpeedReg;
+    vfd.ramp_per_s   = 100000;
+    vfd.set(H2A::MaxRpmReg, 24000);
+
+    uint8_t tx[ModbusRtu::MAX_MSG_SIZE];
+    uint8_t rx[ModbusRtu::MAX_MSG_SIZE];
+    size_t  rx_len = H2A::readRequest(tx, H2A::MaxRpmReg);
+    ASSERT_EQ(transact(vfd, tx, 6, rx_len, rx), 1);
+    EXPECT_EQ(H2A::parseValue(rx), 24000);
+
+    rx_len = H2A::setSpeedRequest(tx, 5000);
+    ASSERT_EQ(transact(vfd, tx, 6, rx_len, rx), 1);
+    vfd.idle(100000);
+    rx_len = H2A::readRequest(tx, H2A::SpeedReg);
+    ASSERT_EQ(transact(vfd, tx, 6, rx_len, rx), 1);
+    EXPECT_EQ(H2A::parseValue(rx), 5000);
+
+    uint8_t response[] = { 0x01, 0x03, 0x00, 0x04, 0x09, 0x5D, 0x00, 0x00 };
+    EXPECT_EQ(H2A::parseValue(response), 2397);
+}
+
+TEST(VFDProtocol, HuanyangMessages) {
+    VFDSimulator vfd;
+    makeHuanyang(vfd);
+    vfd.ramp_per_s = 100000;
+    vfd.set(VFDSimulator::huanyang_settings + 5, 40000);  // PD005, max frequency
+    vfd.set(VFDSimulator::huanyang_status + Huanyang::OutputCurrent, 35);
+
+    uint8_t tx[ModbusRtu::MAX_MSG_SIZE];
+    EXPECT_EQ(huanyang(vfd, Huanyang::settingRequest(tx, 5), tx), 40000);
+    EXPECT_EQ(huanyang(vfd, Huanyang::statusRequest(tx, Huanyang::OutputCurrent), tx), 35);
+
+    // The frequency is only output once the spindle is told to run
+    huanyang(vfd, Huanyang::frequencyRequest(tx, 20000), tx);
+    vfd.idle(500000);
+    EXPECT_EQ(huanyang(vfd, Huanyang::statusRequest(tx, Huanyang::OutputFrequency), tx), 0);
+
+    huanyang(vfd, Huanyang::controlRequest(tx, Huanyang::RunForward), tx);
+    vfd.idle(500000);
+    EXPECT_EQ(huanyang(vfd, Huanyang::statusRequest(tx, Huanyang::OutputFrequency), tx), 20000);
+
+    huanyang(vfd, Huanyang::controlRequest(tx, Huanyang::Stop), tx);
+    vfd.idle(500000);
+    EXPECT_EQ(huanyang(vfd, Huanyang::statusRequest(tx, Huanyang::OutputFrequency), tx), 0);
+}
+
+// Some Huanyangs send a 0x00 ahead of the reply.  exchange() drops it and
+// reads the rest, so the reply is good the first time.
+TEST(VFDProtocol, HuanyangLeadingZero) {
+    VFDSimulator vfd;
+    makeHuanyang(vfd);
+    vfd.set(VFDSimulator::huanyang_status + Huanyang::OutputCurrent, 123);
+    vfd.leading_zeros = 2;
+
+    uint8_t tx[ModbusRtu::MAX_MSG_SIZE];
+    EXPECT_EQ(huanyang(vfd, Huanyang::statusRequest(tx, Huanyang::OutputCurrent), tx), 123);
+    EXPECT_EQ(huanyang(vfd, Huanyang::statusRequest(tx, Huanyang::OutputCurrent), tx), 123);
+    EXPECT_EQ(vfd.requests, 2);
+}
+
+TEST(VFDProtocol, PollPeriod) {
+    EXPECT_EQ(VFDProtocol::pollPeriodMs(true, 50, run_poll_ms), 50u);
+    EXPECT_EQ(VFDProtocol::pollPeriodMs(false, 50, run_poll_ms), run_poll_ms);
+}
+
+TEST(VFDProtocol, AtSpeedWindow) {
+    VFDProtocol::SpeedReport none { VFDProtocol::NoSpeed, 0 };
+
+    EXPECT_TRUE(VFDProtocol::atSpeed({ 3950, 100 }, none, 4000, 100, 0));
+    EXPECT_TRUE(VFDProtocol::atSpeed({ 4100, 100 }, none, 4000, 100, 0));
+    EXPECT_FALSE(VFDProtocol::atSpeed({ 3800, 100 }, none, 4000, 100, 0));
+    EXPECT_TRUE(VFDProtocol::atSpeed({ 50, 100 }, none, 0, 100, 0));
+
+    // Prediction needs two reports, moving toward the window
+    EXPECT_FALSE(VFDProtocol::atSpeed({ 3800, 100 }, none, 4000, 100, 1000));
+    EXPECT_TRUE(VFDProtocol::atSpeed({ 3800, 100 }, { 3700, 50 }, 4000, 100, 1000));
+    EXPECT_FALSE(VFDProtocol::atSpeed({ 3800, 100 }, { 3800, 50 }, 4000, 100, 1000));
+    EXPECT_FALSE(VFDProtocol::atSpeed({ 3800, 100 }, { 3900, 50 }, 4000, 100, 1000));
+    EXPECT_FALSE(VFDProtocol::atSpeed({ 3800, 100 }, { 3700, 100 }, 4000, 100, 1000));
+
+    // 100 units still to go at 2 units/ms is 50 ms away
+    EXPECT_TRUE(VFDProtocol::atSpeed({ 3800, 100 }, { 3700, 50 }, 4000, 100, 50));
+    EXPECT_FALSE(VFDProtocol::atSpeed({ 3800, 100 }, { 3700, 50 }, 4000, 100, 49));
+
+    // Ramping down
+    EXPECT_TRUE(VFDProtocol::atSpeed({ 1200, 100 }, { 1300, 50 }, 1000, 100, 50));
+}
+
+// Without prediction, detection overshoots the ramp by at most one poll
+// period plus the transactions around it.
+TEST(VFDProtocol, AtSpeedLatency) {
+    for (uint32_t poll_ms : { 50, 250 }) {
+        uint64_t latency = atSpeedLatencyUs(poll_ms, 0);
+        EXPECT_GE(latency, ramp_us);
+        EXPECT_LE(latency, ramp_us + poll_ms * 1000 + 2 * transaction_us) << "poll_ms " << poll_ms;
+    }
+}
+
+// Prediction releases about predict_ms before the spindle enters the window,
+// and never before.
+TEST(VFDProtocol, AtSpeedPrediction) {
+    const uint32_t predict_ms = 300;
+
+    for (uint32_t poll_ms : { 50, 250 }) {
+        uint64_t latency = atSpeedLatencyUs(poll_ms, predict_ms);
+        EXPECT_GE(latency + predict_ms * 1000, ramp_us) << "poll_ms " << poll_ms;
+        EXPECT_LE(latency + predict_ms * 1000, ramp_us + poll_ms * 1000 + 2 * transaction_us) << "poll_ms " << poll_ms;
+    }
+
+    // From a running spindle, the ramp is shorter
+    uint64_t latency = atSpeedLatencyUs(50, predict_ms, 2000);
+    EXPECT_LE(latency, (ramp_us - 1000000) - predict_ms * 1000 + 50000 + 2 * transaction_us);
+}
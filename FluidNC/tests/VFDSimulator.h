@@ -0,0 +1,190 @@
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// In-process Modbus RTU slave that stands in for a VFD on the RS485 bus.
+// It implements read holding registers (0x03) and write single register
+// (0x06), which is what H2A, YL620, NowForever and most other VFDs use,
+// and, as the protocol says, the H2A's reply layout and the Huanyang's own
+// function set.
+// Time is simulated: every byte on the wire, every response delay and
+// every receive timeout advances now_us, so latency can be measured
+// without real hardware or wall clock delays.
+
+#include "src/Spindles/ModbusRtu.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
+
+class VFDSimulator : public Spindles::ModbusRtu::Link {
+public:
+    // Bus
+    uint32_t baud = 9600;
+    uint8_t  id   = 1;
+
+    enum class Protocol { Modbus, H2A, Huanyang };
+
+    // VFD model
+    Protocol protocol           = Protocol::Modbus;
+    uint16_t setpoint_reg       = 0x2000;
+    uint16_t speed_reg          = 0x3000;
+    uint32_t ramp_per_s         = 20000;  // device units per second
+    uint32_t response_delay_us  = 5000;   // turnaround time before the reply starts
+    int      crc_faults         = 0;      // corrupt the next N replies
+    int      dropped_responses  = 0;      // ignore the next N requests
+    bool     always_corrupt_crc = false;
+    int      leading_zeros      = 0;  // Precede the next N replies with a 0x00, as some Huanyangs do
+
+    // Huanyang settings and status registers live at these offsets in the
+    // register map.  Set setpoint_reg and speed_reg to status registers 0 and 1.
+    static const uint16_t huanyang_settings = 0x1000;
+    static const uint16_t huanyang_status   = 0x2000;
+
+    // Statistics
+    uint64_t now_us   = 0;
+    int      requests = 0;
+
+    uint16_t speed() { return ramp(), uint16_t(_speed); }
+
+    void set(uint16_t reg, uint16_t value) {
+        ramp();
+        _registers[reg] = value;
+    }
+
+    // Link
+    void flushRx() override { _reply.clear(); }
+
+    void send(const uint8_t* msg, size_t len) override {
+        now_us += byteTimeUs() * len;
+        ++requests;
+        handle(msg, len);
+    }
+
+    size_t receive(uint8_t* buf, size_t len, uint32_t timeout_ms) override {
+        if (_reply.empty() || _reply_at_us > now_us + timeout_ms * 1000ull) {
+            now_us += timeout_ms * 1000ull;
+            return 0;
+        }
+        now_us = std::max(now_us, _reply_at_us);
+        len    = std::min(len, _reply.size());
+        memcpy(buf, _reply.data(), len);
+        _reply.erase(_reply.begin(), _reply.begin() + len);
+        now_us += byteTimeUs() * len;
+        _reply_at_us = now_us;
+        return len;
+    }
+
+    void idle(uint32_t us) override { now_us += us; }
+
+private:
+    std::map<uint16_t, uint16_t> _registers;
+    bool                         _running = false;  // Huanyang only runs after a run command
+    std::vector<uint8_t>         _reply;
+    uint64_t                     _reply_at_us = 0;
+    uint64_t                     _ramped_us   = 0;
+    double                       _speed       = 0;
+
+    uint64_t byteTimeUs() const { return 11 * 1000000ull / baud; }
+
+    // Move the output speed toward the setpoint for the time elapsed since the last call
+    void ramp() {
+        double step   = double(ramp_per_s) * (now_us - _ramped_us) / 1e6;
+        double target = (protocol != Protocol::Huanyang || _running) ? _registers[setpoint_reg] : 0;
+        _ramped_us    = now_us;
+        if (_speed < target) {
+            _speed = std::min(target, _speed + step);
+        } else {
+            _speed = std::max(target, _speed - step);
+        }
+        _registers[speed_reg] = uint16_t(_speed);
+    }
+
+    void handle(const uint8_t* msg, size_t len) {
+        _reply.clear();
+        if (len < 4 || msg[0] != id || Spindles::ModbusRtu::crc(msg, len - 2) != (msg[len - 2] | (msg[len - 1] << 8))) {
+            return;
+        }
+        if (dropped_responses > 0) {
+            --dropped_responses;
+            return;
+        }
+        ramp();
+
+        if (protocol == Protocol::Huanyang) {
+            huanyang(msg);
+        } else {
+            modbus(msg);
+        }
+        if (_reply.empty()) {
+            return;
+        }
+
+        uint8_t frame[Spindles::ModbusRtu::MAX_MSG_SIZE + 1];
+        size_t  length = 0;
+        if (leading_zeros > 0) {
+            --leading_zeros;
+            frame[length++] = 0;
+        }
+        std::copy(_reply.begin(), _reply.end(), frame + length);
+        length = length + Spindles::ModbusRtu::appendCrc(frame + length, _reply.size());
+        if (always_corrupt_crc || crc_faults > 0) {
+            crc_faults -= crc_faults > 0;
+            frame[length - 1] ^= 0xFF;
+        }
+        _reply.assign(frame, frame + length);
+        _reply_at_us = now_us + response_delay_us;
+    }
+
+    void modbus(const uint8_t* msg) {
+        uint16_t reg = (msg[2] << 8) | msg[3];
+        uint16_t arg = (msg[4] << 8) | msg[5];
+        switch (msg[1]) {
+            case 0x03:  // Read holding registers
+                if (protocol == Protocol::H2A) {
+                    _reply = { id, 0x03, 0x00, uint8_t(arg * 2) };  // 16-bit byte count
+                } else {
+                    _reply = { id, 0x03, uint8_t(arg * 2) };
+                }
+                for (uint16_t i = 0; i < arg; ++i) {
+                    uint16_t value = _registers[reg + i];
+                    _reply.push_back(value >> 8);
+                    _reply.push_back(value & 0xFF);
+                }
+                break;
+            case 0x06:  // Write single register, echoed back
+                _registers[reg] = arg;
+                _reply.assign(msg, msg + 6);
+                break;
+            default:
+                return;
+        }
+    }
+
+    // Function, data length, data; the reply has the same layout
+    void huanyang(const uint8_t* msg) {
+        uint16_t value;
+        switch (msg[1]) {
+            case 0x01:  // Read setting PDnnn
+                value  = _registers[huanyang_settings + msg[3]];
+                _reply = { id, msg[1], 0x03, msg[3], uint8_t(value >> 8), uint8_t(value & 0xFF) };
+                break;
+            case 0x03:  // Control
+                _running = msg[3] == 0x01 || msg[3] == 0x11;
+                _reply   = { id, msg[1], 0x01, msg[3] };
+                break;
+            case 0x04:  // Read status
+                value  = _registers[huanyang_status + msg[3]];
+                _reply = { id, msg[1], 0x03, msg[3], uint8_t(value >> 8), uint8_t(value & 0xFF) };
+                break;
+            case 0x05:  // Write frequency
+                _registers[setpoint_reg] = (msg[3] << 8) | msg[4];
+                _reply                   = { id, msg[1], 0x02, msg[3], msg[4] };
+                break;
+            default:
+                return;
+        }
+    }
+};